@@ -0,0 +1,157 @@
+#include "ArapRefiner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// constraint weight relative to the mean diagonal of the Laplacian: small enough for the
+	// rigidity term to matter, large enough to keep the result close to the cage map
+	const double kFit = 0.1;
+
+	double cotangent(const Eigen::Vector2d& u, const Eigen::Vector2d& v)
+	{
+		double cross = std::abs(u[0] * v[1] - u[1] * v[0]);
+		return cross > 1e-12 * u.norm() * v.norm() ? u.dot(v) / cross : 0.0;
+	}
+}
+
+void ArapRefiner::SetRest(const Mesh& mesh)
+{
+	Clear();
+	int n = int(mesh.n_vertices());
+	m_Rest.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		m_Rest[i] = Eigen::Vector2d(mesh.points()[i][0], mesh.points()[i][1]);
+	}
+	for (auto fh : mesh.faces())
+	{
+		for (const auto& fvh : mesh.fv_range(fh))
+		{
+			m_Triangles.push_back(fvh.idx());
+		}
+	}
+}
+
+void ArapRefiner::Clear(void)
+{
+	m_Rest.clear();
+	m_Triangles.clear();
+	m_Weights.resize(0, 0);
+	m_Factorized = false;
+	m_Guide.clear();
+	m_Rotations.clear();
+	m_Rhs.resize(0, 2);
+}
+
+bool ArapRefiner::Factorize(void)
+{
+	if (m_Factorized)
+		return true;
+	int n = int(m_Rest.size());
+	if (n == 0)
+		return false;
+	std::vector<Eigen::Triplet<double>> triplets;
+	triplets.reserve(m_Triangles.size() * 2);
+	for (int f = 0; f + 2 < int(m_Triangles.size()); f += 3)
+	{
+		const int* t = &m_Triangles[f];
+		for (int k = 0; k < 3; k++)
+		{
+			int a = t[k], b = t[(k + 1) % 3], c = t[(k + 2) % 3];
+			double w = 0.5 * cotangent(m_Rest[a] - m_Rest[c], m_Rest[b] - m_Rest[c]);
+			triplets.emplace_back(a, b, w);
+			triplets.emplace_back(b, a, w);
+		}
+	}
+	m_Weights.resize(n, n);
+	m_Weights.setFromTriplets(triplets.begin(), triplets.end());
+	// obtuse angles give negative weights, which can make the Laplacian indefinite
+	for (int k = 0; k < m_Weights.outerSize(); k++)
+	{
+		for (Eigen::SparseMatrix<double>::InnerIterator it(m_Weights, k); it; ++it)
+		{
+			it.valueRef() = std::max(it.value(), 0.0);
+		}
+	}
+
+	Eigen::VectorXd diag = Eigen::VectorXd::Zero(n);
+	for (int k = 0; k < m_Weights.outerSize(); k++)
+	{
+		for (Eigen::SparseMatrix<double>::InnerIterator it(m_Weights, k); it; ++it)
+		{
+			diag[k] += it.value();
+		}
+	}
+	m_Fit = kFit * std::max(diag.mean(), 1e-12);
+	Eigen::SparseMatrix<double> D(n, n);
+	D.setIdentity();
+	D.diagonal() = diag + Eigen::VectorXd::Constant(n, m_Fit);
+	m_Solver.compute(D - m_Weights);
+	if (m_Solver.info() != Eigen::Success)
+	{
+		std::cerr << "ERROR: ARAP system of " << n << " vertices cannot be factorized" << std::endl;
+		return false;
+	}
+	m_Rotations.resize(n);
+	m_Rhs.resize(n, 2);
+	m_Factorized = true;
+	return true;
+}
+
+bool ArapRefiner::Refine(Point* pts, int n, const std::vector<int>& pinned)
+{
+	if (!Ready(n) || !m_Factorized)
+		return false;
+	m_Guide.assign(pts, pts + n);
+	for (int it = 0; it < kIterations; it++)
+	{
+		// local step: the rotation closest to the map of each vertex's rest edges
+		#pragma omp parallel for
+		for (int i = 0; i < n; i++)
+		{
+			Eigen::Matrix2d S = Eigen::Matrix2d::Zero();
+			for (Eigen::SparseMatrix<double>::InnerIterator e(m_Weights, i); e; ++e)
+			{
+				int j = int(e.index());
+				Eigen::Vector2d r = m_Rest[i] - m_Rest[j];
+				Eigen::Vector2d p(pts[i][0] - pts[j][0], pts[i][1] - pts[j][1]);
+				S += e.value() * r * p.transpose();
+			}
+			double angle = std::atan2(S(0, 1) - S(1, 0), S(0, 0) + S(1, 1));
+			double c = std::cos(angle), s = std::sin(angle);
+			m_Rotations[i] << c, -s, s, c;
+		}
+		// global step with the cached factorization, the cage result pulls every vertex
+		#pragma omp parallel for
+		for (int i = 0; i < n; i++)
+		{
+			Eigen::Vector2d b(m_Fit * m_Guide[i][0], m_Fit * m_Guide[i][1]);
+			for (Eigen::SparseMatrix<double>::InnerIterator e(m_Weights, i); e; ++e)
+			{
+				int j = int(e.index());
+				b += 0.5 * e.value() * (m_Rotations[i] + m_Rotations[j]) * (m_Rest[i] - m_Rest[j]);
+			}
+			m_Rhs.row(i) = b.transpose();
+		}
+		Eigen::MatrixX2d x = m_Solver.solve(m_Rhs);
+		for (int i = 0; i < n; i++)
+		{
+			pts[i][0] = x(i, 0);
+			pts[i][1] = x(i, 1);
+		}
+	}
+	for (int v : pinned)
+	{
+		pts[v] = m_Guide[v];
+	}
+	return true;
+}
+
+void ArapRefiner::Restore(Point* pts, int n)
+{
+	if (int(m_Guide.size()) != n)
+		return;
+	std::copy(m_Guide.begin(), m_Guide.end(), pts);
+	m_Guide.clear();
+}
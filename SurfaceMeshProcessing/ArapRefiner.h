@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include "MeshDefinition.h"
+
+// Hybrid deformation: a few as-rigid-as-possible iterations (x/y only) on top of the Green
+// coordinate result. The cage result is both the initial guess of the local/global iterations
+// and a soft positional constraint on every vertex, so the refinement only restores local
+// rigidity where the cage map shears or scales, and the system matrix (cotangent Laplacian of
+// the rest mesh plus the constraint weight) does not depend on the cage. It is factorized once
+// per rest mesh, by Factorize() when refinement is switched on or the rest mesh changes, and
+// reused by every refinement until SetRest() is called again; Refine() never factorizes.
+class ArapRefiner
+{
+public:
+	typedef Mesh::Point Point;
+	static const int kIterations = 3;
+
+public:
+	// rest pose and triangles of the mesh the weights were computed on; drops the factorization
+	void SetRest(const Mesh& mesh);
+	void Clear(void);
+	bool Ready(int n) const { return n > 0 && int(m_Rest.size()) == n; }
+	// system matrix of the rest mesh, does nothing when it is factorized already
+	bool Factorize(void);
+	bool Factorized() const { return m_Factorized; }
+
+	// pts hold the cage result of the rest mesh's vertices; it is kept as guide and pts are
+	// refined in place, the z coordinates and the pinned vertices are left as they are. False
+	// without a factorization.
+	bool Refine(Point* pts, int n, const std::vector<int>& pinned);
+	// puts the guide of the last Refine() back, for updates that add to the cage result
+	// instead of overwriting it; afterwards there is no guide until the next Refine()
+	void Restore(Point* pts, int n);
+
+private:
+	std::vector<Eigen::Vector2d> m_Rest;
+	std::vector<int> m_Triangles;
+	Eigen::SparseMatrix<double> m_Weights;//symmetric cotangent weights of the rest edges
+	double m_Fit = 0;//weight of the positional constraints
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> m_Solver;
+	bool m_Factorized = false;
+	std::vector<Point> m_Guide;
+	std::vector<Eigen::Matrix2d> m_Rotations;
+	Eigen::MatrixX2d m_Rhs;
+};
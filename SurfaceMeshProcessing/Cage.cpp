@@ -0,0 +1,274 @@
+#include "Cage.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void Cage::Reset(const std::vector<Point>& points, int degree)
+{
+	m_Degree = degree;
+	m_X.resize(points.size());
+	m_Y.resize(points.size());
+	for (int i = 0; i < int(points.size()); i++)
+	{
+		m_X[i] = points[i][0];
+		m_Y[i] = points[i][1];
+	}
+	int N = degree > 0 ? int(points.size()) / degree : 0;
+	m_Offset.resize(N + 1);
+	for (int s = 0; s <= N; s++)
+	{
+		m_Offset[s] = s * degree;
+	}
+	Layout();
+}
+
+void Cage::Reset(const SegmentList& bezier)
+{
+	m_Degree = bezier.empty() ? 0 : int(bezier[0].size()) - 1;
+	m_X.clear();
+	m_Y.clear();
+	m_Offset.assign(1, 0);
+	for (const auto& seg : bezier)
+	{
+		for (int j = 0; j + 1 < int(seg.size()); j++)
+		{
+			m_X.push_back(seg[j][0]);
+			m_Y.push_back(seg[j][1]);
+		}
+		m_Offset.push_back(Size());
+	}
+	Layout();
+}
+
+void Cage::Clear(void)
+{
+	m_Degree = 0;
+	m_X.clear();
+	m_Y.clear();
+	m_Offset.assign(1, 0);
+	Layout();
+}
+
+void Cage::Layout(void)
+{
+	int n = Size();
+	int N = SegmentCount();
+	m_SegmentOf.assign(n, -1);
+	m_PointsStale = true;
+	int maxDegree = 0;
+	for (int s = 0; s < N; s++)
+	{
+		std::fill(m_SegmentOf.begin() + m_Offset[s], m_SegmentOf.begin() + m_Offset[s + 1], s);
+		maxDegree = std::max(maxDegree, SegmentDegree(s));
+	}
+	m_Selection.assign((n + 63) / 64, 0);
+	m_Binomial.assign(maxDegree + 1, std::vector<double>(maxDegree + 1, 0.0));
+	for (int d = 0; d <= maxDegree; d++)
+	{
+		m_Binomial[d][0] = 1;
+		for (int k = 1; k <= d; k++)
+		{
+			m_Binomial[d][k] = m_Binomial[d - 1][k - 1] + m_Binomial[d - 1][k];
+		}
+	}
+	m_Version.assign(N, ++m_Edits);
+	m_Monomial.resize(N);
+	m_Stale.assign(N, 1);
+	m_StaleMonomial.resize(N);
+	for (int s = 0; s < N; s++)
+	{
+		m_Monomial[s].resize(SegmentDegree(s) + 1);
+		m_StaleMonomial[s] = s;
+	}
+}
+
+int Cage::PointOf(int s, int j) const
+{
+	int p = m_Offset[s] + j;
+	return p == Size() ? 0 : p;
+}
+
+void Cage::Mark(int s)
+{
+	m_Version[s] = ++m_Edits;
+	if (!m_Stale[s])
+		m_StaleMonomial.push_back(s);
+	m_Stale[s] = 1;
+}
+
+void Cage::Touch(int i)
+{
+	int N = SegmentCount();
+	if (N == 0)
+		return;
+	int s = m_SegmentOf[i];
+	if (s >= 0)
+		Mark(s);
+	// the first point of a segment is also the last one of the previous segment
+	if (s > 0 && i == m_Offset[s])
+		Mark(s - 1);
+	else if (i == PointOf(N - 1, SegmentDegree(N - 1)))
+		Mark(N - 1);
+}
+
+void Cage::SetPoint(int i, const Point& p)
+{
+	m_X[i] = p[0];
+	m_Y[i] = p[1];
+	m_PointsStale = true;
+	Touch(i);
+}
+
+void Cage::SetPoints(const std::vector<Point>& points)
+{
+	assert(int(points.size()) == Size());
+	for (int i = 0; i < int(points.size()); i++)
+	{
+		if (points[i][0] != m_X[i] || points[i][1] != m_Y[i])
+			SetPoint(i, points[i]);
+	}
+}
+
+void Cage::MovePoints(const int* ids, int n, const Point& delta)
+{
+	for (int k = 0; k < n; k++)
+	{
+		SetPoint(ids[k], At(ids[k]) + delta);
+	}
+}
+
+void Cage::Insert(int index, const std::vector<Point>& points)
+{
+	const auto& old = Points();
+	std::vector<Point> all;
+	all.reserve(old.size() + points.size());
+	all.insert(all.end(), old.begin(), old.begin() + index);
+	all.insert(all.end(), points.begin(), points.end());
+	all.insert(all.end(), old.begin() + index, old.end());
+	Reset(all, m_Degree);
+}
+
+void Cage::Erase(int index, int count)
+{
+	std::vector<Point> all(Points());
+	all.erase(all.begin() + index, all.begin() + index + count);
+	Reset(all, m_Degree);
+}
+
+void Cage::Select(int i, bool on)
+{
+	std::uint64_t bit = std::uint64_t(1) << (i & 63);
+	if (on)
+		m_Selection[i >> 6] |= bit;
+	else
+		m_Selection[i >> 6] &= ~bit;
+}
+
+void Cage::ClearSelection(void)
+{
+	std::fill(m_Selection.begin(), m_Selection.end(), 0);
+}
+
+void Cage::SelectedIds(std::vector<int>& ids) const
+{
+	ids.clear();
+	for (int w = 0; w < int(m_Selection.size()); w++)
+	{
+		for (std::uint64_t word = m_Selection[w]; word; word &= word - 1)
+		{
+			int b = 0;
+			while (!((word >> b) & 1))
+				b++;
+			ids.push_back(64 * w + b);
+		}
+	}
+}
+
+int Cage::Nearest(const Point& p, double maxDist) const
+{
+	int best = -1;
+	double bestSqr = maxDist * maxDist;
+	for (int i = 0; i < Size(); i++)
+	{
+		double dx = X(i) - p[0], dy = Y(i) - p[1];
+		double sqr = dx * dx + dy * dy;
+		if (sqr <= bestSqr && (best < 0 || sqr < bestSqr))
+		{
+			best = i;
+			bestSqr = sqr;
+		}
+	}
+	return best;
+}
+
+double Cage::MeanEdgeLength() const
+{
+	int n = Size();
+	if (n == 0)
+		return 0.0;
+	double total = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		int j = i + 1 == n ? 0 : i + 1;
+		total += std::hypot(X(j) - X(i), Y(j) - Y(i));
+	}
+	return total / n;
+}
+
+const std::vector<Cage::Point>& Cage::Points() const
+{
+	if (m_PointsStale)
+	{
+		m_Points.resize(Size());
+		for (int i = 0; i < Size(); i++)
+		{
+			m_Points[i] = At(i);
+		}
+		m_PointsStale = false;
+	}
+	return m_Points;
+}
+
+Cage::SegmentList Cage::Bezier() const
+{
+	SegmentList bezier(SegmentCount());
+	for (int s = 0; s < SegmentCount(); s++)
+	{
+		Segment(s, bezier[s]);
+	}
+	return bezier;
+}
+
+void Cage::Segment(int s, std::vector<Point>& seg) const
+{
+	seg.resize(SegmentDegree(s) + 1);
+	for (int j = 0; j < int(seg.size()); j++)
+	{
+		seg[j] = SegmentPoint(s, j);
+	}
+}
+
+const Cage::SegmentList& Cage::Monomial() const
+{
+	// a_k = C(d, k) sum_i (-1)^(k - i) C(k, i) P_i
+	for (int s : m_StaleMonomial)
+	{
+		auto& poly = m_Monomial[s];
+		int d = int(poly.size()) - 1;
+		for (int k = 0; k <= d; k++)
+		{
+			double ax = 0, ay = 0;
+			for (int i = 0; i <= k; i++)
+			{
+				double b = m_Binomial[k][i] * ((k - i) % 2 == 0 ? 1 : -1);
+				int p = PointOf(s, i);
+				ax += b * m_X[p];
+				ay += b * m_Y[p];
+			}
+			poly[k] = Point(m_Binomial[d][k] * ax, m_Binomial[d][k] * ay, 0);
+		}
+		m_Stale[s] = 0;
+	}
+	m_StaleMonomial.clear();
+	return m_Monomial;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MeshDefinition.h"
+
+// The curve cage of the viewer: one array of control points in counterclockwise order and a
+// table of closed Bezier segments over it, segment s running from point Offset(s) over
+// SegmentDegree(s) + 1 points, the last one wrapping to point 0. The coordinates are stored
+// once, as x/y arrays (the cage is planar) that the scans over all points and the deformers
+// read; Points() is a view for the modules that take a point array, refreshed from the arrays
+// on the first call after an edit. Segments read the arrays through SegmentPoint() rather than
+// keeping copies. Every edit stamps the segments it changes with a new version, so each
+// consumer (the deformers, the BVH) can find the segments that changed since it last looked
+// without the cage tracking who has seen what.
+// The power basis coefficients are cached per segment and recomputed on request for the stale
+// segments only. The selection is a bitset over the points.
+class Cage
+{
+public:
+	typedef Mesh::Point Point;
+	typedef std::vector<std::vector<Point>> SegmentList;
+
+public:
+	// degree points per segment, as many segments as fit (further points belong to none, as in
+	// CageDeformer); clears the selection
+	void Reset(const std::vector<Point>& points, int degree);
+	// from Bezier segments whose ends coincide, each one keeps its degree
+	void Reset(const SegmentList& bezier);
+	void Clear(void);
+	bool Empty() const { return m_X.empty(); }
+	int Size() const { return int(m_X.size()); }
+	// degree of the uniform layout, used again after an insertion or removal
+	int Degree() const { return m_Degree; }
+	int SegmentCount() const { return int(m_Offset.size()) - 1; }
+	int Offset(int s) const { return m_Offset[s]; }
+	int SegmentDegree(int s) const { return m_Offset[s + 1] - m_Offset[s]; }
+	// control point j (0..SegmentDegree(s)) of segment s
+	Point SegmentPoint(int s, int j) const { return At(PointOf(s, j)); }
+	// increases whenever a point of segment s moves or the layout changes, never repeats
+	std::uint64_t SegmentVersion(int s) const { return m_Version[s]; }
+
+	double X(int i) const { return m_X[i]; }
+	double Y(int i) const { return m_Y[i]; }
+	Point At(int i) const { return Point(m_X[i], m_Y[i], 0); }
+	// all points, z = 0; kept between calls, so a drag that reads it every move does not allocate
+	const std::vector<Point>& Points() const;
+
+	void SetPoint(int i, const Point& p);
+	// moves every point that differs from points (same count as the cage)
+	void SetPoints(const std::vector<Point>& points);
+	void MovePoints(const int* ids, int n, const Point& delta);
+	// the points are laid out in segments of Degree() again and the selection is cleared
+	void Insert(int index, const std::vector<Point>& points);
+	void Erase(int index, int count);
+
+	bool Selected(int i) const { return (m_Selection[i >> 6] >> (i & 63)) & 1; }
+	void Select(int i, bool on);
+	void Toggle(int i) { Select(i, !Selected(i)); }
+	void ClearSelection(void);
+	// selected points in increasing order, ids keeps its capacity
+	void SelectedIds(std::vector<int>& ids) const;
+
+	// point nearest to p (x/y only) within maxDist, -1 when there is none
+	int Nearest(const Point& p, double maxDist) const;
+	// mean distance between consecutive points, the last one to the first
+	double MeanEdgeLength() const;
+
+	// control points of every segment, the end point repeated as the start of the next one; a
+	// new list for the modules that take one (weights, inside tests), drags do not call it
+	SegmentList Bezier() const;
+	// points of segment s into seg, which keeps its capacity
+	void Segment(int s, std::vector<Point>& seg) const;
+	// c_0..c_d of every segment in power basis, as GreenCoords::cageWeights takes them
+	const SegmentList& Monomial() const;
+
+private:
+	void Layout(void);
+	void Touch(int i);
+	void Mark(int s);
+	int PointOf(int s, int j) const;
+
+private:
+	int m_Degree = 0;
+	std::vector<double> m_X, m_Y;
+	mutable std::vector<Point> m_Points;//view of m_X/m_Y, see Points()
+	mutable bool m_PointsStale = true;
+	std::vector<int> m_Offset{ 0 };//first point of every segment, plus the end of the last one
+	std::vector<int> m_SegmentOf;//segment a point starts or lies inside of, -1 for none
+	std::vector<std::uint64_t> m_Selection;
+	std::vector<std::uint64_t> m_Version;//per segment
+	std::uint64_t m_Edits = 0;//last version handed out, kept over Reset()
+	mutable SegmentList m_Monomial;
+	mutable std::vector<char> m_Stale;//per segment, monomial out of date
+	mutable std::vector<int> m_StaleMonomial;
+	std::vector<std::vector<double>> m_Binomial;//up to the highest segment degree
+};
@@ -0,0 +1,199 @@
+#include "CageAnimation.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+void CageAnimation::AddKeyframe(double time, const std::vector<Point>& points)
+{
+	auto it = std::lower_bound(m_Keys.begin(), m_Keys.end(), time,
+		[](const Keyframe& key, double t) { return key.time < t; });
+	if (it != m_Keys.end() && it->time == time)
+		it->points = points;
+	else
+		m_Keys.insert(it, Keyframe{ time, points });
+}
+
+bool CageAnimation::LoadKeyframes(const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in)
+	{
+		std::cerr << "ERROR: cannot open keyframes " << filename << std::endl;
+		return false;
+	}
+	std::string line;
+	std::vector<Point> points;
+	double time = 0.00;
+	bool timed = false;
+	int nKeys = 0;
+	while (std::getline(in, line))
+	{
+		if (line.compare(0, 4, "time") == 0)
+		{
+			time = std::atof(line.c_str() + 4);
+			timed = true;
+			continue;
+		}
+		// "{" may share its line with the first point
+		std::size_t pos = 0;
+		while (pos < line.size())
+		{
+			std::size_t brace = line.find_first_of("{}", pos);
+			std::size_t vec = line.find("Vec3d(", pos);
+			if (vec < brace)
+			{
+				Point p(0, 0, 0);
+				if (std::sscanf(line.c_str() + vec + 6, "%lf , %lf , %lf", &p[0], &p[1], &p[2]) == 3)
+					points.push_back(p);
+				pos = vec + 6;
+			}
+			else if (brace != std::string::npos)
+			{
+				if (line[brace] == '{')
+				{
+					points.clear();
+				}
+				else
+				{
+					AddKeyframe(timed ? time : (m_Keys.empty() ? 0.00 : EndTime() + 1), points);
+					timed = false;
+					nKeys++;
+				}
+				pos = brace + 1;
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+	std::cout << nKeys << " keyframes from " << filename << std::endl;
+	return nKeys > 0;
+}
+
+void CageAnimation::Pose(double t, std::vector<Point>& points) const
+{
+	assert(!m_Keys.empty());
+	int n = int(m_Keys.size());
+	if (n == 1 || t <= StartTime())
+	{
+		points = m_Keys.front().points;
+		return;
+	}
+	if (t >= EndTime())
+	{
+		points = m_Keys.back().points;
+		return;
+	}
+	int i = int(std::upper_bound(m_Keys.begin(), m_Keys.end(), t,
+		[](double t, const Keyframe& key) { return t < key.time; }) - m_Keys.begin()) - 1;
+	const auto& p0 = m_Keys[std::max(i - 1, 0)].points;
+	const auto& p1 = m_Keys[i].points;
+	const auto& p2 = m_Keys[i + 1].points;
+	const auto& p3 = m_Keys[std::min(i + 2, n - 1)].points;
+	double u = (t - m_Keys[i].time) / (m_Keys[i + 1].time - m_Keys[i].time);
+	double u2 = u * u, u3 = u2 * u;
+	// Catmull-Rom basis
+	double b0 = 0.5 * (-u3 + 2 * u2 - u);
+	double b1 = 0.5 * (3 * u3 - 5 * u2 + 2);
+	double b2 = 0.5 * (-3 * u3 + 4 * u2 + u);
+	double b3 = 0.5 * (u3 - u2);
+	points.resize(p1.size());
+	for (int k = 0; k < int(p1.size()); k++)
+	{
+		points[k] = b0 * p0[k] + b1 * p1[k] + b2 * p2[k] + b3 * p3[k];
+	}
+}
+
+int CageAnimation::Render(double fps, const BatchDeformer& deform, const FrameWriter& write) const
+{
+	if (m_Keys.empty() || fps <= 0)
+		return 0;
+	for (const auto& key : m_Keys)
+	{
+		if (key.points.size() != m_Keys.front().points.size())
+		{
+			std::cerr << "ERROR: keyframes with different numbers of control points" << std::endl;
+			return -1;
+		}
+	}
+	int nFrames = int(std::floor((EndTime() - StartTime()) * fps + 1e-9)) + 1;
+
+	struct Batch {
+		int first;
+		int count;
+		std::vector<Point> frames;
+	};
+	std::deque<Batch> queue;
+	std::mutex mutex;
+	std::condition_variable changed;
+	bool finished = false, failed = false;
+	int written = 0;
+
+	// the writer waits for batches, the deformation for room in the queue
+	std::thread writer([&] {
+		while (true)
+		{
+			Batch batch;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&] { return !queue.empty() || finished || failed; });
+				if (queue.empty() || failed)
+					return;
+				batch = std::move(queue.front());
+				queue.pop_front();
+			}
+			changed.notify_all();
+			std::size_t n = batch.frames.size() / batch.count;
+			for (int f = 0; f < batch.count; f++)
+			{
+				if (!write(batch.first + f, batch.frames.data() + f * n))
+				{
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						failed = true;
+					}
+					changed.notify_all();
+					return;
+				}
+				written++;
+			}
+		}
+	});
+
+	std::vector<std::vector<Point>> poses;
+	for (int first = 0; first < nFrames; first += kBatch)
+	{
+		Batch batch;
+		batch.first = first;
+		batch.count = std::min(int(kBatch), nFrames - first);
+		poses.resize(batch.count);
+		for (int f = 0; f < batch.count; f++)
+		{
+			Pose(StartTime() + (first + f) / fps, poses[f]);
+		}
+		bool ok = deform(poses, batch.frames);
+		std::unique_lock<std::mutex> lock(mutex);
+		failed = failed || !ok;
+		changed.wait(lock, [&] { return int(queue.size()) < kQueueBatches || failed; });
+		if (failed)
+			break;
+		queue.push_back(std::move(batch));
+		lock.unlock();
+		changed.notify_all();
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	changed.notify_all();
+	writer.join();
+	return failed ? -1 : written;
+}
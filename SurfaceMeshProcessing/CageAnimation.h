@@ -0,0 +1,47 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "MeshDefinition.h"
+
+// Keyframed cage poses on a timeline. A pose is an array of control points laid out like
+// Cage::Points(); in between keyframes the control points follow Catmull-Rom curves through the
+// keys (clamped at both ends). Render() samples the timeline, deforms the poses a batch at a
+// time and streams the frames to a writer thread through a queue of bounded length.
+class CageAnimation
+{
+public:
+	typedef Mesh::Point Point;
+	struct Keyframe {
+		double time;
+		std::vector<Point> points;
+	};
+	// poses -> frames (poses.size() blocks of points, one per pose); false if it cannot deform them
+	typedef std::function<bool(const std::vector<std::vector<Point>>& poses, std::vector<Point>& frames)> BatchDeformer;
+	// frame index, its points; false stops the rendering
+	typedef std::function<bool(int frame, const Point* points)> FrameWriter;
+
+	static const int kDefaultFps = 30;
+	// poses deformed together, and batches that may wait for the writer
+	static const int kBatch = 16;
+	static const int kQueueBatches = 4;
+
+public:
+	// keeps the keyframes sorted by time, a key at an existing time replaces it
+	void AddKeyframe(double time, const std::vector<Point>& points);
+	// blocks in the format printed on MouseButtonRelease ({ OpenMesh::Vec3d(x, y, z), ... }),
+	// each optionally preceded by a line "time t"; keys without a time follow the last one by 1
+	bool LoadKeyframes(const std::string& filename);
+	void Clear(void) { m_Keys.clear(); }
+	const std::vector<Keyframe>& Keyframes() const { return m_Keys; }
+	double StartTime() const { return m_Keys.empty() ? 0.00 : m_Keys.front().time; }
+	double EndTime() const { return m_Keys.empty() ? 0.00 : m_Keys.back().time; }
+
+	void Pose(double t, std::vector<Point>& points) const;
+	// frames at fps from the first to the last keyframe; returns the number of frames written,
+	// -1 if deforming or writing failed
+	int Render(double fps, const BatchDeformer& deform, const FrameWriter& write) const;
+
+private:
+	std::vector<Keyframe> m_Keys;
+};
@@ -0,0 +1,281 @@
+#include "CageBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static const int kStackSize = 64;
+
+static inline double boxDistance(double xmin, double xmax, double ymin, double ymax, const CageBVH::Point& p)
+{
+	double dx = std::max(0.00, std::max(xmin - p[0], p[0] - xmax));
+	double dy = std::max(0.00, std::max(ymin - p[1], p[1] - ymax));
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+void CageBVH::Build(const std::vector<std::vector<Point>>& bezierCage)
+{
+	m_Segments = bezierCage;
+	m_Nodes.clear();
+	int S = int(m_Segments.size());
+	m_Leaf.assign(S, -1);
+	m_Seen.assign(S, 0);//versions start at 1, the first Refit() takes every segment over
+	if (S == 0)
+		return;
+	Point pmin = m_Segments[0][0], pmax = m_Segments[0][0];
+	for (const auto& seg : m_Segments)
+	{
+		for (const auto& p : seg)
+		{
+			pmin.minimize(p);
+			pmax.maximize(p);
+		}
+	}
+	m_Tol = 1e-9 * (pmax - pmin).norm();
+	std::vector<int> order(S);
+	for (int s = 0; s < S; s++)
+	{
+		order[s] = s;
+	}
+	m_Nodes.reserve(2 * S - 1);
+	BuildNode(order.data(), order.data() + S, -1);
+}
+
+int CageBVH::BuildNode(int* first, int* last, int parent)
+{
+	int idx = int(m_Nodes.size());
+	m_Nodes.push_back(Node());
+	m_Nodes[idx].parent = parent;
+	if (last - first == 1)
+	{
+		m_Nodes[idx].segment = *first;
+		m_Leaf[*first] = idx;
+		SetLeafBox(m_Nodes[idx]);
+		return idx;
+	}
+	// median split of the segment centers along the longer side of their bounding box
+	auto center = [this](int s, int axis) {
+		const auto& seg = m_Segments[s];
+		return 0.5 * (seg.front()[axis] + seg.back()[axis]);
+	};
+	double cmin[2] = { INFINITY, INFINITY }, cmax[2] = { -INFINITY, -INFINITY };
+	for (int* it = first; it != last; ++it)
+	{
+		for (int a = 0; a < 2; a++)
+		{
+			cmin[a] = std::min(cmin[a], center(*it, a));
+			cmax[a] = std::max(cmax[a], center(*it, a));
+		}
+	}
+	int axis = cmax[0] - cmin[0] >= cmax[1] - cmin[1] ? 0 : 1;
+	int* mid = first + (last - first) / 2;
+	std::nth_element(first, mid, last, [&](int i, int j) { return center(i, axis) < center(j, axis); });
+	int left = BuildNode(first, mid, idx);
+	int right = BuildNode(mid, last, idx);
+	m_Nodes[idx].left = left;
+	m_Nodes[idx].right = right;
+	MergeChildren(m_Nodes[idx]);
+	return idx;
+}
+
+void CageBVH::SetLeafBox(Node& node) const
+{
+	const auto& seg = m_Segments[node.segment];
+	node.xmin = node.xmax = seg[0][0];
+	node.ymin = node.ymax = seg[0][1];
+	for (const auto& p : seg)
+	{
+		node.xmin = std::min(node.xmin, p[0]);
+		node.xmax = std::max(node.xmax, p[0]);
+		node.ymin = std::min(node.ymin, p[1]);
+		node.ymax = std::max(node.ymax, p[1]);
+	}
+}
+
+void CageBVH::MergeChildren(Node& node) const
+{
+	const Node& l = m_Nodes[node.left];
+	const Node& r = m_Nodes[node.right];
+	node.xmin = std::min(l.xmin, r.xmin);
+	node.xmax = std::max(l.xmax, r.xmax);
+	node.ymin = std::min(l.ymin, r.ymin);
+	node.ymax = std::max(l.ymax, r.ymax);
+}
+
+int CageBVH::Refit(const Cage& cage)
+{
+	int N = cage.SegmentCount();
+	if (N != int(m_Segments.size()) || m_Nodes.empty())
+	{
+		Build(cage.Bezier());
+		m_Seen.resize(N);
+		for (int s = 0; s < N; s++)
+		{
+			m_Seen[s] = cage.SegmentVersion(s);
+		}
+		return N;
+	}
+	int moved = 0;
+	for (int s = 0; s < N; s++)
+	{
+		if (cage.SegmentVersion(s) == m_Seen[s])
+			continue;
+		m_Seen[s] = cage.SegmentVersion(s);
+		cage.Segment(s, m_Segments[s]);
+		int idx = m_Leaf[s];
+		SetLeafBox(m_Nodes[idx]);
+		for (idx = m_Nodes[idx].parent; idx >= 0; idx = m_Nodes[idx].parent)
+		{
+			MergeChildren(m_Nodes[idx]);
+		}
+		moved++;
+	}
+	return moved;
+}
+
+void CageBVH::NearestSegments(const Point* pts, int nPts, int* seg, double* dist, double* t, double maxDist) const
+{
+#pragma omp parallel for schedule(dynamic, 64)
+	for (int k = 0; k < nPts; k++)
+	{
+		const Point& p = pts[k];
+		double best = maxDist, bestT = 0.00;
+		int bestSeg = -1;
+		int stack[kStackSize];
+		int top = 0;
+		if (!m_Nodes.empty())
+			stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node& node = m_Nodes[stack[--top]];
+			if (boxDistance(node.xmin, node.xmax, node.ymin, node.ymax, p) >= best)
+				continue;
+			if (node.segment >= 0)
+			{
+				double tt = 0.00;
+				double d = CageGeometry::segmentDistance(m_Segments[node.segment], p, m_Tol, &tt, best);
+				if (d < best)
+				{
+					best = d;
+					bestT = tt;
+					bestSeg = node.segment;
+				}
+				continue;
+			}
+			const Node& l = m_Nodes[node.left];
+			const Node& r = m_Nodes[node.right];
+			bool leftFirst = boxDistance(l.xmin, l.xmax, l.ymin, l.ymax, p) < boxDistance(r.xmin, r.xmax, r.ymin, r.ymax, p);
+			stack[top++] = leftFirst ? node.right : node.left;
+			stack[top++] = leftFirst ? node.left : node.right;
+		}
+		seg[k] = bestSeg;
+		dist[k] = best;
+		if (t)
+			t[k] = bestT;
+	}
+}
+
+int CageBVH::Winding(const Point& p, double tol, bool& on) const
+{
+	// segments whose boxes miss the ray cross it as often as their chords, i.e. never
+	int winding = 0;
+	int stack[kStackSize];
+	int top = 0;
+	if (!m_Nodes.empty())
+		stack[top++] = 0;
+	while (top > 0)
+	{
+		const Node& node = m_Nodes[stack[--top]];
+		if (node.ymin - tol > p[1] || node.ymax + tol < p[1] || node.xmax + tol < p[0])
+			continue;
+		if (node.segment >= 0)
+		{
+			winding += CageGeometry::segmentCrossing(m_Segments[node.segment], p, tol, on);
+			continue;
+		}
+		stack[top++] = node.left;
+		stack[top++] = node.right;
+	}
+	return winding;
+}
+
+bool CageBVH::Contains(const Point& p, bool* onCage) const
+{
+	bool on = false;
+	int winding = Winding(p, m_Tol, on);
+	if (onCage)
+		*onCage = on;
+	return winding != 0 && !on;
+}
+
+int CageBVH::ClassifyPoints(const Point* pts, int nPts, std::vector<char>& side) const
+{
+	// same tolerance as CageGeometry::classifyPoints, 1e-6 of the cage diagonal
+	double tol = 1e3 * m_Tol;
+	side.resize(nPts);
+	int count = 0;
+#pragma omp parallel for schedule(dynamic, 256) reduction(+:count)
+	for (int k = 0; k < nPts; k++)
+	{
+		bool on = false;
+		int winding = Winding(pts[k], tol, on);
+		side[k] = char(on ? CageGeometry::OnCage : winding != 0 ? CageGeometry::Inside : CageGeometry::Outside);
+		count += side[k] != CageGeometry::Inside;
+	}
+	return count;
+}
+
+bool CageBVH::Adjacent(int i, int j) const
+{
+	int S = int(m_Segments.size());
+	int d = std::abs(i - j);
+	return d <= 1 || d == S - 1;
+}
+
+void CageBVH::SelfIntersections(std::vector<std::pair<int, int>>& pairs) const
+{
+	pairs.clear();
+	if (m_Nodes.empty())
+		return;
+	auto& stack = m_PairStack;
+	stack.clear();
+	stack.push_back(std::make_pair(0, 0));
+	while (!stack.empty())
+	{
+		auto nodes = stack.back();
+		stack.pop_back();
+		const Node& a = m_Nodes[nodes.first];
+		const Node& b = m_Nodes[nodes.second];
+		if (nodes.first == nodes.second)
+		{
+			if (a.segment < 0)
+			{
+				stack.push_back(std::make_pair(a.left, a.left));
+				stack.push_back(std::make_pair(a.right, a.right));
+				stack.push_back(std::make_pair(a.left, a.right));
+			}
+			continue;
+		}
+		if (a.xmin > b.xmax + m_Tol || b.xmin > a.xmax + m_Tol || a.ymin > b.ymax + m_Tol || b.ymin > a.ymax + m_Tol)
+			continue;
+		if (a.segment >= 0 && b.segment >= 0)
+		{
+			int i = std::min(a.segment, b.segment), j = std::max(a.segment, b.segment);
+			if (!Adjacent(i, j) && CageGeometry::segmentsIntersect(m_Segments[i], m_Segments[j], m_Tol))
+				pairs.push_back(std::make_pair(i, j));
+			continue;
+		}
+		// descend into the internal node with the larger box
+		bool splitA = b.segment >= 0 || (a.segment < 0 && (a.xmax - a.xmin) + (a.ymax - a.ymin) >= (b.xmax - b.xmin) + (b.ymax - b.ymin));
+		if (splitA)
+		{
+			stack.push_back(std::make_pair(a.left, nodes.second));
+			stack.push_back(std::make_pair(a.right, nodes.second));
+		}
+		else
+		{
+			stack.push_back(std::make_pair(nodes.first, b.left));
+			stack.push_back(std::make_pair(nodes.first, b.right));
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+}
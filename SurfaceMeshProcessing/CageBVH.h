@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "CageGeometry.h"
+#include "Cage.h"
+
+// Bounding volume hierarchy over the segments of a curved cage. Every leaf holds one Bezier
+// segment and the box of its control polygon, which contains the curve. Refit() updates the
+// boxes of the segments whose Cage version changed and their ancestors only, the tree itself
+// is kept as long as the number of segments does not change. Below kMinSegments segments
+// CageGeometry::classifyPoints, which tests the chords of all segments for a block of points
+// at once, is as fast as walking the tree for every point.
+class CageBVH
+{
+public:
+	typedef CageGeometry::Point Point;
+
+public:
+	static const int kMinSegments = 8;
+
+public:
+	void Build(const std::vector<std::vector<Point>>& bezierCage);
+	// rebuilds when the segment count changed, returns the number of leaves that moved
+	int Refit(const Cage& cage);
+	bool Empty() const { return m_Nodes.empty(); }
+	double Tolerance() const { return m_Tol; }
+
+	// nearest segment of every point with its distance and, if t is non-null, its curve parameter.
+	// Segments farther than maxDist are skipped, seg is -1 when there is none within maxDist.
+	void NearestSegments(const Point* pts, int nPts, int* seg, double* dist, double* t = nullptr, double maxDist = INFINITY) const;
+	// winding number test, only the segments whose boxes meet the +x ray are visited
+	bool Contains(const Point& p, bool* onCage = nullptr) const;
+	// CageGeometry::Side of every point with the tolerance of classifyPoints, returns the number of points that are not Inside
+	int ClassifyPoints(const Point* pts, int nPts, std::vector<char>& side) const;
+	// pairs of segments that are not neighbours along the cage and intersect, pairs keeps its capacity
+	void SelfIntersections(std::vector<std::pair<int, int>>& pairs) const;
+
+private:
+	struct Node {
+		double xmin, xmax, ymin, ymax;
+		int left = -1, right = -1;
+		int parent = -1;
+		int segment = -1;
+	};
+	int BuildNode(int* first, int* last, int parent);
+	void SetLeafBox(Node& node) const;
+	void MergeChildren(Node& node) const;
+	bool Adjacent(int i, int j) const;
+	int Winding(const Point& p, double tol, bool& on) const;
+
+private:
+	std::vector<std::vector<Point>> m_Segments;
+	std::vector<std::uint64_t> m_Seen;//Cage::SegmentVersion of every segment as of the last Refit()
+	std::vector<Node> m_Nodes;
+	std::vector<int> m_Leaf;//leaf node of every segment
+	mutable std::vector<std::pair<int, int>> m_PairStack;//kept between calls so that dragging does not allocate
+	double m_Tol = 0.00;
+};
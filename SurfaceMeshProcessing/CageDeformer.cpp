@@ -0,0 +1,279 @@
+#include "CageDeformer.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+int CageDeformer::Columns(const Cage& cage, Basis basis)
+{
+	if (basis == ControlPoints)
+		return cage.Size();
+	int K = 0;
+	for (int s = 0; s < cage.SegmentCount(); s++)
+	{
+		K += 2 * cage.SegmentDegree(s) + 1;
+	}
+	return K;
+}
+
+void CageDeformer::Reset(const Cage& cage, Basis basis)
+{
+	m_Basis = basis;
+	int N = cage.SegmentCount();
+	m_FirstRow.resize(N);
+	for (int s = 0, row = 0; s < N; s++)
+	{
+		m_FirstRow[s] = basis == PowerBasis ? row : cage.Offset(s);
+		row += 2 * cage.SegmentDegree(s) + 1;
+	}
+	m_Seen.resize(N);
+	int K = Columns(cage, basis);
+	m_Coeffs.setConstant(K, 2, std::numeric_limits<double>::quiet_NaN());
+	m_ChangedRows.clear();
+	m_ChangedRows.reserve(K);
+	m_RowChanged.assign(K, 0);
+	m_Delta.resize(K, 2);
+	if (basis == ControlPoints)
+	{
+		// points after the last segment have rows too
+		for (int p = 0; p < K; p++)
+		{
+			SetRow(p, cage.X(p), cage.Y(p));
+		}
+	}
+	for (int s = 0; s < N; s++)
+	{
+		UpdateSegment(cage, s);
+	}
+	m_Applied = m_Coeffs;
+	m_ChangedRows.clear();
+	m_RowChanged.assign(K, 0);
+	m_Updates = 0;
+}
+
+void CageDeformer::SetRow(int row, double x, double y)
+{
+	if (m_Coeffs(row, 0) == x && m_Coeffs(row, 1) == y)
+		return;
+	m_Coeffs(row, 0) = x;
+	m_Coeffs(row, 1) = y;
+	if (!m_RowChanged[row])
+	{
+		m_RowChanged[row] = 1;
+		m_ChangedRows.push_back(row);
+	}
+}
+
+void CageDeformer::UpdateSegment(const Cage& cage, int s)
+{
+	m_Seen[s] = cage.SegmentVersion(s);
+	int row = m_FirstRow[s];
+	int d = cage.SegmentDegree(s);
+	if (m_Basis == ControlPoints)
+	{
+		for (int j = 0; j < d; j++)
+		{
+			const Point& p = cage.SegmentPoint(s, j);
+			SetRow(row + j, p[0], p[1]);
+		}
+		return;
+	}
+	const auto& poly = cage.Monomial()[s];
+	for (int k = 0; k <= d; k++)
+	{
+		double x = poly[k][0], y = poly[k][1];
+		SetRow(row + k, x, y);
+		// arthono(c) = (c.y, -c.x)
+		if (k > 0)
+			SetRow(row + d + k, y, -x);
+	}
+}
+
+void CageDeformer::Update(const Cage& cage)
+{
+	assert(cage.SegmentCount() == int(m_Seen.size()));
+	for (int s = 0; s < int(m_Seen.size()); s++)
+	{
+		if (cage.SegmentVersion(s) != m_Seen[s])
+			UpdateSegment(cage, s);
+	}
+	UpdateDelta();
+}
+
+void CageDeformer::UpdateDelta(void)
+{
+	for (int i = 0; i < int(m_ChangedRows.size()); i++)
+	{
+		m_Delta.row(i) = m_Coeffs.row(m_ChangedRows[i]) - m_Applied.row(m_ChangedRows[i]);
+	}
+}
+
+int CageDeformer::ChunkRows(int columns)
+{
+	return std::max(16, std::min(4096, kChunkBytes / (std::max(columns, 1) * int(sizeof(double)))));
+}
+
+int CageDeformer::BlockColumns(int coeffColumns)
+{
+	return kCoeffBytes / (coeffColumns * int(sizeof(double)));
+}
+
+// rows [first, first + n) of out = those weight rows times the C columns of coeffs (column major,
+// leading dimension ld) over weight columns [b, b + m), added to out unless b == 0; out(r, c) is
+// out[r * rowStride + c * colStride]. Four partial sums per column vectorize without reassociation.
+template <int C>
+static void RowBlockProduct(const WeightMatrix& weights, const double* coeffs, int ld, int first, int n, int b, int m, double* out, int rowStride, int colStride)
+{
+	int m4 = m & ~3;
+	for (int r = first; r < first + n; r++)
+	{
+		const double* w = weights.row(r).data() + b;
+		double acc[C][4] = {};
+		for (int k = 0; k < m4; k += 4)
+		{
+			for (int c = 0; c < C; c++)
+			{
+				const double* col = coeffs + c * ld + b + k;
+				for (int j = 0; j < 4; j++)
+				{
+					acc[c][j] += w[k + j] * col[j];
+				}
+			}
+		}
+		double* o = out + std::size_t(r) * rowStride;
+		for (int c = 0; c < C; c++)
+		{
+			const double* col = coeffs + c * ld + b;
+			double sum = (acc[c][0] + acc[c][1]) + (acc[c][2] + acc[c][3]);
+			for (int k = m4; k < m; k++)
+			{
+				sum += w[k] * col[k];
+			}
+			o[c * colStride] = b == 0 ? sum : o[c * colStride] + sum;
+		}
+	}
+}
+
+// out = weights * coeffs chunk by chunk, in place and without any workspace
+template <int C>
+static void ChunkedProduct(const WeightMatrix& weights, const double* coeffs, int ld, double* out, int rowStride, int colStride)
+{
+	int rows = int(weights.rows());
+	int K = int(weights.cols());
+	int chunk = CageDeformer::ChunkRows(K);
+	int block = std::min(CageDeformer::BlockColumns(C), K);
+	int nChunks = (rows + chunk - 1) / chunk;
+#pragma omp parallel for schedule(static)
+	for (int c = 0; c < nChunks; c++)
+	{
+		int first = c * chunk;
+		int n = std::min(chunk, rows - first);
+		for (int b = 0; b < K; b += block)
+		{
+			RowBlockProduct<C>(weights, coeffs, ld, first, n, b, std::min(block, K - b), out, rowStride, colStride);
+		}
+	}
+}
+
+void CageDeformer::Product(const WeightMatrix& weights, const Eigen::Ref<const Eigen::MatrixXd>& coeffs, Point* pts)
+{
+	assert(weights.cols() == coeffs.rows() && (coeffs.cols() == 2 || coeffs.cols() == 3));
+	if (coeffs.cols() == 2)
+		ChunkedProduct<2>(weights, coeffs.data(), int(coeffs.outerStride()), pts->data(), 3, 1);
+	else
+		ChunkedProduct<3>(weights, coeffs.data(), int(coeffs.outerStride()), pts->data(), 3, 1);
+}
+
+void CageDeformer::DeformPoses(const WeightMatrix& weights, const Eigen::MatrixXd& coeffs, const double* z, Point* out)
+{
+	assert(weights.cols() == coeffs.rows() && coeffs.cols() % 2 == 0);
+	int V = int(weights.rows());
+	int P = int(coeffs.cols()) / 2;
+	int chunk = kPoseChunk;
+	int nChunks = (V + chunk - 1) / chunk;
+#pragma omp parallel
+	{
+		Eigen::MatrixXd xy(chunk, 2 * P);
+		// Eigen runs the product on the calling thread inside a parallel region
+#pragma omp for schedule(static)
+		for (int c = 0; c < nChunks; c++)
+		{
+			int first = c * chunk;
+			int n = std::min(chunk, V - first);
+			xy.topRows(n).noalias() = weights.middleRows(first, n) * coeffs;
+			for (int p = 0; p < P; p++)
+			{
+				Point* o = out + std::size_t(p) * V + first;
+				for (int k = 0; k < n; k++)
+				{
+					o[k] = Point(xy(k, 2 * p), xy(k, 2 * p + 1), z[first + k]);
+				}
+			}
+		}
+	}
+}
+
+void CageDeformer::Deform(const WeightMatrix& weights, Point* pts) const
+{
+	assert(weights.cols() == Columns());
+	Product(weights, m_Coeffs, pts);
+}
+
+void CageDeformer::Apply(const WeightMatrix& weights, Eigen::Matrix<double, Eigen::Dynamic, 2>& out) const
+{
+	assert(weights.cols() == Columns());
+	out.resize(weights.rows(), 2);
+	ChunkedProduct<2>(weights, m_Coeffs.data(), int(m_Coeffs.rows()), out.data(), 1, int(out.rows()));
+}
+
+template <typename Add>
+void CageDeformer::ForEachChanged(const WeightMatrix& weights, Add add) const
+{
+	assert(weights.cols() == Columns());
+	const int* rows = m_ChangedRows.data();
+	int n = int(m_ChangedRows.size());
+#pragma omp parallel for schedule(static)
+	for (int k = 0; k < int(weights.rows()); k++)
+	{
+		const double* w = weights.row(k).data();
+		double x = 0.00, y = 0.00;
+		for (int i = 0; i < n; i++)
+		{
+			x += w[rows[i]] * m_Delta(i, 0);
+			y += w[rows[i]] * m_Delta(i, 1);
+		}
+		add(k, x, y);
+	}
+}
+
+void CageDeformer::DeformChanged(const WeightMatrix& weights, Point* pts) const
+{
+	ForEachChanged(weights, [pts](int k, double x, double y) {
+		pts[k][0] += x;
+		pts[k][1] += y;
+	});
+}
+
+void CageDeformer::ApplyChanged(const WeightMatrix& weights, Eigen::Matrix<double, Eigen::Dynamic, 2>& out) const
+{
+	assert(out.rows() == weights.rows());
+	ForEachChanged(weights, [&out](int k, double x, double y) {
+		out(k, 0) += x;
+		out(k, 1) += y;
+	});
+}
+
+bool CageDeformer::FullUpdateDue() const
+{
+	return m_Updates % kFullEvery == 0 || 2 * ChangedColumns() > Columns();
+}
+
+void CageDeformer::Commit(void)
+{
+	for (int r : m_ChangedRows)
+	{
+		m_Applied.row(r) = m_Coeffs.row(r);
+		m_RowChanged[r] = 0;
+	}
+	m_ChangedRows.clear();
+	m_Updates++;
+}
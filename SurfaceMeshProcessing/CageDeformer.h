@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MeshDefinition.h"
+#include "Cage.h"
+
+// Drag path of the cage deformation. Reset() allocates every buffer for the layout of a Cage.
+// Update() then only rebuilds the coefficient rows of the segments whose version changed since
+// the last Reset() or Update(), reading them from the cage (its points and cached power basis
+// coefficients) rather than from a copy of its own, and Deform() writes weights * coefficients
+// straight into a point array, so none of them allocates.
+// The map is linear in the coefficients, so when a few points moved DeformChanged() adds
+// weights[:, changed] * delta for the coefficient rows changed since the last Commit() only;
+// FullUpdateDue() asks for a full product every kFullEvery updates to bound the drift.
+// Coefficient rows follow the weight layouts of the viewer:
+//   PowerBasis     c_0..c_d, arthono(c_1..c_d) of every segment in power basis (Green weights)
+//   ControlPoints  the control points themselves (cubic MVC weights folded onto them)
+class CageDeformer
+{
+public:
+	typedef Mesh::Point Point;
+	enum Basis {
+		PowerBasis,
+		ControlPoints
+	};
+
+	static const int kFullEvery = 32;
+	// the products run over vertex chunks in parallel: a chunk holds about kChunkBytes of weight
+	// rows, and long rows are split into column blocks whose coefficients (at most kCoeffBytes)
+	// stay in L1 while the chunk streams by
+	static const int kChunkBytes = 128 * 1024;
+	static const int kCoeffBytes = 16 * 1024;
+	// vertices per block of the multi-pose product
+	static const int kPoseChunk = 256;
+
+public:
+	void Reset(const Cage& cage, Basis basis);
+	// takes over the segments of cage (same layout as in Reset) edited since the last call
+	void Update(const Cage& cage);
+	// coefficient rows for the layout of cage
+	static int Columns(const Cage& cage, Basis basis);
+
+	int Columns() const { return int(m_Coeffs.rows()); }
+	const Eigen::Matrix<double, Eigen::Dynamic, 2>& Coefficients() const { return m_Coeffs; }
+
+	// x/y of pts[k] = row k of weights times the coefficients, z is left as it is
+	void Deform(const WeightMatrix& weights, Point* pts) const;
+	// out = weights * coefficients, out keeps its storage when it already has the right size
+	void Apply(const WeightMatrix& weights, Eigen::Matrix<double, Eigen::Dynamic, 2>& out) const;
+
+	// x/y(/z) of pts[k] = row k of weights times the 2 (3) coefficient columns, written in place
+	static void Product(const WeightMatrix& weights, const Eigen::Ref<const Eigen::MatrixXd>& coeffs, Point* pts);
+	// one point set under many poses: columns 2p, 2p + 1 of coeffs are the coefficients of pose p
+	// (rows as in Coefficients()); every block of weight rows is read once for all poses. out
+	// holds the poses one after another, weights.rows() points each, with z[k] as z of point k
+	static void DeformPoses(const WeightMatrix& weights, const Eigen::MatrixXd& coeffs, const double* z, Point* out);
+	// vertices per chunk for weight rows of the given length
+	static int ChunkRows(int columns);
+	// weight columns per block for the given number of coefficient columns
+	static int BlockColumns(int coeffColumns);
+
+	// incremental versions: the targets must hold the result of the previous update
+	void DeformChanged(const WeightMatrix& weights, Point* pts) const;
+	void ApplyChanged(const WeightMatrix& weights, Eigen::Matrix<double, Eigen::Dynamic, 2>& out) const;
+	int ChangedColumns() const { return int(m_ChangedRows.size()); }
+	// first update after Reset(), every kFullEvery-th update, or when most columns changed
+	bool FullUpdateDue() const;
+	// the current coefficients have been written to every target, full or not
+	void Commit(void);
+
+private:
+	void UpdateSegment(const Cage& cage, int s);
+	void UpdateDelta(void);
+	// writes a coefficient row and records it as changed unless it keeps its value
+	void SetRow(int row, double x, double y);
+	template <typename Add>
+	void ForEachChanged(const WeightMatrix& weights, Add add) const;
+
+private:
+	Basis m_Basis = PowerBasis;
+	std::vector<int> m_FirstRow;//first coefficient row of every segment
+	std::vector<std::uint64_t> m_Seen;//segment versions the rows were built from
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_Coeffs;
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_Applied;//coefficients as of the last Commit()
+	std::vector<int> m_ChangedRows;//capacity Columns(), reserved in Reset()
+	std::vector<char> m_RowChanged;
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_Delta;//row i: change of m_ChangedRows[i]
+	int m_Updates = 0;
+};
@@ -0,0 +1,322 @@
+#include "CageGeometry.h"
+#include <algorithm>
+#include <cassert>
+namespace CageGeometry {
+	const int kMaxDegree = 7;
+	const int kBlock = 256;
+	const int kMaxDepth = 40;
+
+	struct Box {
+		double xmin, xmax, ymin, ymax;
+	};
+
+	inline Box controlBox(const double* x, const double* y, int d, double tol) {
+		Box b = { x[0], x[0], y[0], y[0] };
+		for (int p = 1; p <= d; p++) {
+			b.xmin = std::min(b.xmin, x[p]);
+			b.xmax = std::max(b.xmax, x[p]);
+			b.ymin = std::min(b.ymin, y[p]);
+			b.ymax = std::max(b.ymax, y[p]);
+		}
+		b.xmin -= tol;
+		b.xmax += tol;
+		b.ymin -= tol;
+		b.ymax += tol;
+		return b;
+	}
+
+	// de Casteljau at t = 1/2, l and r may not alias x and y
+	inline void splitHalf(const double* x, const double* y, int d, double* lx, double* ly, double* rx, double* ry) {
+		double wx[kMaxDegree + 1], wy[kMaxDegree + 1];
+		std::copy(x, x + d + 1, wx);
+		std::copy(y, y + d + 1, wy);
+		for (int r = 0; r <= d; r++) {
+			lx[r] = wx[0];
+			ly[r] = wy[0];
+			rx[d - r] = wx[d - r];
+			ry[d - r] = wy[d - r];
+			for (int p = 0; p < d - r; p++) {
+				wx[p] = 0.5 * (wx[p] + wx[p + 1]);
+				wy[p] = 0.5 * (wy[p] + wy[p + 1]);
+			}
+		}
+	}
+
+	inline double boxDistance(const Box& b, double px, double py) {
+		double dx = std::max(0.00, std::max(b.xmin - px, px - b.xmax));
+		double dy = std::max(0.00, std::max(b.ymin - py, py - b.ymax));
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	inline bool boxesOverlap(const Box& a, const Box& b) {
+		return a.xmin <= b.xmax && b.xmin <= a.xmax && a.ymin <= b.ymax && b.ymin <= a.ymax;
+	}
+
+	// control points of one segment as x/y arrays
+	struct Control {
+		double x[kMaxDegree + 1], y[kMaxDegree + 1];
+		int d;
+		explicit Control(const std::vector<Point>& c) {
+			d = int(c.size()) - 1;
+			assert(d >= 1 && d <= kMaxDegree);
+			for (int p = 0; p <= d; p++) {
+				x[p] = c[p][0];
+				y[p] = c[p][1];
+			}
+		}
+		Control() : d(0) {}
+	};
+
+	// signed crossing of the chord x[0] -> x[d] with the ray from (px, py) towards +x
+	inline int chordCrossing(const double* x, const double* y, int d, double px, double py) {
+		double ax = x[0] - px, ay = y[0] - py;
+		double bx = x[d] - px, by = y[d] - py;
+		double side = ax * by - ay * bx;
+		return (ay <= 0 && by > 0 && side > 0) - (by <= 0 && ay > 0 && side < 0);
+	}
+
+	// crossings of the segment around (px, py), which lies inside the segment box
+	static int subdividedCrossing(const double* x, const double* y, int d, double px, double py, double tol, int depth, bool& on) {
+		Box b = controlBox(x, y, d, tol);
+		if (px < b.xmin || px > b.xmax || py < b.ymin || py > b.ymax) {
+			return chordCrossing(x, y, d, px, py);
+		}
+		if (depth == 0 || (b.xmax - b.xmin <= 4 * tol && b.ymax - b.ymin <= 4 * tol)) {
+			on = true;
+			return 0;
+		}
+		double lx[kMaxDegree + 1], ly[kMaxDegree + 1], rx[kMaxDegree + 1], ry[kMaxDegree + 1];
+		splitHalf(x, y, d, lx, ly, rx, ry);
+		return subdividedCrossing(lx, ly, d, px, py, tol, depth - 1, on)
+			+ subdividedCrossing(rx, ry, d, px, py, tol, depth - 1, on);
+	}
+
+	void windingNumbers(const std::vector<std::vector<Point>>& bezierCage, const Point* pts, int nPts, double tol, int* wn, char* onCage) {
+		int S = int(bezierCage.size());
+		std::vector<double> cx, cy;
+		std::vector<int> degree(S), offset(S);
+		std::vector<Box> boxes(S);
+		for (int s = 0; s < S; s++) {
+			degree[s] = int(bezierCage[s].size()) - 1;
+			assert(degree[s] >= 1 && degree[s] <= kMaxDegree);
+			offset[s] = int(cx.size());
+			for (const auto& p : bezierCage[s]) {
+				cx.push_back(p[0]);
+				cy.push_back(p[1]);
+			}
+			boxes[s] = controlBox(&cx[offset[s]], &cy[offset[s]], degree[s], tol);
+		}
+
+		int nBlocks = (nPts + kBlock - 1) / kBlock;
+#pragma omp parallel
+		{
+			double px[kBlock], py[kBlock], wind[kBlock], inBox[kBlock];
+			int pending[kBlock];
+			bool on[kBlock];
+#pragma omp for schedule(dynamic, 4)
+			for (int blk = 0; blk < nBlocks; blk++) {
+				int k0 = blk * kBlock;
+				int n = std::min(kBlock, nPts - k0);
+				for (int l = 0; l < n; l++) {
+					px[l] = pts[k0 + l][0];
+					py[l] = pts[k0 + l][1];
+					wind[l] = 0.00;
+					on[l] = false;
+				}
+				for (int s = 0; s < S; s++) {
+					const double* x = &cx[offset[s]];
+					const double* y = &cy[offset[s]];
+					int d = degree[s];
+					const Box b = boxes[s];
+					double ax0 = x[0], ay0 = y[0], bx0 = x[d], by0 = y[d];
+					// branch free over the block: outside the box the segment crosses the ray like its chord
+					for (int l = 0; l < n; l++) {
+						double ax = ax0 - px[l], ay = ay0 - py[l];
+						double bx = bx0 - px[l], by = by0 - py[l];
+						double side = ax * by - ay * bx;
+						double up = (ay <= 0) & (by > 0) & (side > 0);
+						double down = (by <= 0) & (ay > 0) & (side < 0);
+						inBox[l] = (px[l] >= b.xmin) & (px[l] <= b.xmax) & (py[l] >= b.ymin) & (py[l] <= b.ymax);
+						wind[l] += (1.00 - inBox[l]) * (up - down);
+					}
+					int nPending = 0;
+					for (int l = 0; l < n; l++) {
+						pending[nPending] = l;
+						nPending += inBox[l] != 0;
+					}
+					for (int i = 0; i < nPending; i++) {
+						int l = pending[i];
+						wind[l] += subdividedCrossing(x, y, d, px[l], py[l], tol, kMaxDepth, on[l]);
+					}
+				}
+				for (int l = 0; l < n; l++) {
+					wn[k0 + l] = int(std::lround(wind[l]));
+					if (onCage) {
+						onCage[k0 + l] = on[l];
+					}
+				}
+			}
+		}
+	}
+
+	int classifyPoints(const std::vector<std::vector<Point>>& bezierCage, const Point* pts, int nPts, std::vector<char>& side) {
+		side.assign(nPts, Outside);
+		if (bezierCage.empty()) {
+			return nPts;
+		}
+		Point pmin = bezierCage[0][0], pmax = bezierCage[0][0];
+		for (const auto& seg : bezierCage) {
+			for (const auto& p : seg) {
+				pmin.minimize(p);
+				pmax.maximize(p);
+			}
+		}
+		double tol = 1e-6 * (pmax - pmin).norm();
+		std::vector<int> wn(nPts);
+		std::vector<char> on(nPts);
+		windingNumbers(bezierCage, pts, nPts, tol, wn.data(), on.data());
+		int count = 0;
+		for (int k = 0; k < nPts; k++) {
+			if (on[k]) {
+				side[k] = OnCage;
+			}
+			else if (wn[k] != 0) {
+				side[k] = Inside;
+			}
+			count += side[k] != Inside;
+		}
+		return count;
+	}
+
+	int segmentCrossing(const std::vector<Point>& ctrl, const Point& p, double tol, bool& on) {
+		Control c(ctrl);
+		return subdividedCrossing(c.x, c.y, c.d, p[0], p[1], tol, kMaxDepth, on);
+	}
+
+	// position and first two derivatives of a Bezier segment at t
+	static void evaluate(const Control& c, double t, double* pos, double* d1, double* d2) {
+		double wx[kMaxDegree + 1], wy[kMaxDegree + 1];
+		std::copy(c.x, c.x + c.d + 1, wx);
+		std::copy(c.y, c.y + c.d + 1, wy);
+		d2[0] = d2[1] = 0.00;
+		for (int r = c.d; r >= 1; r--) {
+			if (r == 2) {
+				d2[0] = c.d * (c.d - 1) * (wx[2] - 2 * wx[1] + wx[0]);
+				d2[1] = c.d * (c.d - 1) * (wy[2] - 2 * wy[1] + wy[0]);
+			}
+			if (r == 1) {
+				d1[0] = c.d * (wx[1] - wx[0]);
+				d1[1] = c.d * (wy[1] - wy[0]);
+			}
+			for (int p = 0; p < r; p++) {
+				wx[p] += t * (wx[p + 1] - wx[p]);
+				wy[p] += t * (wy[p + 1] - wy[p]);
+			}
+		}
+		pos[0] = wx[0];
+		pos[1] = wy[0];
+	}
+
+	double segmentDistance(const std::vector<Point>& ctrl, const Point& p, double tol, double* t, double bound) {
+		// branch and bound over the subdivision tree: the control box bounds the distance from
+		// below, the curve point at the middle of every piece from above. Bounding down to tol
+		// would keep O(1/sqrt(tol)) pieces alive around a minimum, so it stops at 1% of the
+		// segment size and Newton iterations on (c(t) - p) . c'(t) = 0 finish the job.
+		struct Piece {
+			Control c;
+			double t0, t1;
+		};
+		Piece stack[2 * kMaxDepth + 2];
+		int top = 0;
+		stack[top].c = Control(ctrl);
+		Box rootBox = controlBox(stack[top].c.x, stack[top].c.y, stack[top].c.d, 0.00);
+		if (boxDistance(rootBox, p[0], p[1]) >= bound) {
+			return bound;
+		}
+		stack[top].t0 = 0.00;
+		stack[top].t1 = 1.00;
+		top++;
+		const Control root = stack[0].c;
+		double best = std::hypot(root.x[0] - p[0], root.y[0] - p[1]), bestT = 0.00;
+		double end = std::hypot(root.x[root.d] - p[0], root.y[root.d] - p[1]);
+		if (end < best) {
+			best = end;
+			bestT = 1.00;
+		}
+		double slack = std::max(tol, 1e-2 * ((rootBox.xmax - rootBox.xmin) + (rootBox.ymax - rootBox.ymin)));
+		while (top > 0) {
+			Piece piece = stack[--top];
+			Box b = controlBox(piece.c.x, piece.c.y, piece.c.d, 0.00);
+			if (boxDistance(b, p[0], p[1]) >= std::min(best, bound) - slack) {
+				continue;
+			}
+			Piece l, r;
+			l.c.d = r.c.d = piece.c.d;
+			splitHalf(piece.c.x, piece.c.y, piece.c.d, l.c.x, l.c.y, r.c.x, r.c.y);
+			double tm = 0.5 * (piece.t0 + piece.t1);
+			double dm = std::hypot(r.c.x[0] - p[0], r.c.y[0] - p[1]);
+			if (dm < best) {
+				best = dm;
+				bestT = tm;
+			}
+			if ((b.xmax - b.xmin) + (b.ymax - b.ymin) <= slack || top + 2 > 2 * kMaxDepth + 2) {
+				continue;
+			}
+			l.t0 = piece.t0;
+			l.t1 = tm;
+			r.t0 = tm;
+			r.t1 = piece.t1;
+			// nearer half on top
+			bool leftFirst = boxDistance(controlBox(l.c.x, l.c.y, l.c.d, 0.00), p[0], p[1]) < boxDistance(controlBox(r.c.x, r.c.y, r.c.d, 0.00), p[0], p[1]);
+			stack[top++] = leftFirst ? r : l;
+			stack[top++] = leftFirst ? l : r;
+		}
+		for (int it = 0; it < 8; it++) {
+			double pos[2], d1[2], d2[2];
+			evaluate(root, bestT, pos, d1, d2);
+			double ex = pos[0] - p[0], ey = pos[1] - p[1];
+			double f = ex * d1[0] + ey * d1[1];
+			double df = d1[0] * d1[0] + d1[1] * d1[1] + ex * d2[0] + ey * d2[1];
+			if (df <= 0) {
+				break;
+			}
+			double tn = std::min(1.00, std::max(0.00, bestT - f / df));
+			evaluate(root, tn, pos, d1, d2);
+			double dn = std::hypot(pos[0] - p[0], pos[1] - p[1]);
+			if (dn >= best) {
+				break;
+			}
+			best = dn;
+			bestT = tn;
+		}
+		if (t) {
+			*t = bestT;
+		}
+		return best;
+	}
+
+	static bool subdividedIntersect(const Control& a, const Control& b, double tol, int depth) {
+		Box ba = controlBox(a.x, a.y, a.d, 0.00), bb = controlBox(b.x, b.y, b.d, 0.00);
+		if (!boxesOverlap(controlBox(a.x, a.y, a.d, tol), bb)) {
+			return false;
+		}
+		double sa = (ba.xmax - ba.xmin) + (ba.ymax - ba.ymin);
+		double sb = (bb.xmax - bb.xmin) + (bb.ymax - bb.ymin);
+		if (depth == 0 || std::max(sa, sb) <= tol) {
+			return true;
+		}
+		Control l, r;
+		if (sa >= sb) {
+			l.d = r.d = a.d;
+			splitHalf(a.x, a.y, a.d, l.x, l.y, r.x, r.y);
+			return subdividedIntersect(l, b, tol, depth - 1) || subdividedIntersect(r, b, tol, depth - 1);
+		}
+		l.d = r.d = b.d;
+		splitHalf(b.x, b.y, b.d, l.x, l.y, r.x, r.y);
+		return subdividedIntersect(a, l, tol, depth - 1) || subdividedIntersect(a, r, tol, depth - 1);
+	}
+
+	bool segmentsIntersect(const std::vector<Point>& a, const std::vector<Point>& b, double tol) {
+		return subdividedIntersect(Control(a), Control(b), tol, 2 * kMaxDepth);
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
+
+
+namespace CageGeometry {
+	typedef OpenMesh::Vec3d Point;
+
+	enum Side {
+		Inside = 0,
+		Outside = 1,
+		OnCage = 2
+	};
+
+	// Winding numbers of nPts points around a closed cage of Bezier segments, each given by its
+	// control points (x/y, any degree up to 7), counted as signed crossings of a ray towards +x.
+	// The control polygon bounds its segment, so for a point outside the box of a segment the
+	// segment crosses the ray like its chord; this is evaluated for all points of a block at once
+	// and only the few points inside a box go on to de Casteljau subdivision.
+	// onCage[k] (when non-null) is set when pts[k] is within about tol of the cage.
+	void windingNumbers(const std::vector<std::vector<Point>>& bezierCage, const Point* pts, int nPts, double tol, int* wn, char* onCage = nullptr);
+
+	// Side of every point (tol relative to the cage bounding box). Returns the number of points
+	// that are not Inside.
+	int classifyPoints(const std::vector<std::vector<Point>>& bezierCage, const Point* pts, int nPts, std::vector<char>& side);
+
+	// Single segment primitives, all refined by de Casteljau subdivision down to tol.
+	// segmentCrossing: signed crossings of the +x ray from p, on is set when p is on the segment.
+	// segmentDistance: distance from p, t (when non-null) receives the parameter of the closest point;
+	// returns bound right away when the control box is already that far.
+	// segmentsIntersect: whether the two segments come within tol of each other.
+	int segmentCrossing(const std::vector<Point>& ctrl, const Point& p, double tol, bool& on);
+	double segmentDistance(const std::vector<Point>& ctrl, const Point& p, double tol, double* t = nullptr, double bound = INFINITY);
+	bool segmentsIntersect(const std::vector<Point>& a, const std::vector<Point>& b, double tol);
+}
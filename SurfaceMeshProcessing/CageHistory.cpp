@@ -0,0 +1,139 @@
+#include "CageHistory.h"
+#include <set>
+
+void CageHistory::Clear(void)
+{
+	m_Undo.clear();
+	m_Redo.clear();
+	m_Cache.clear();
+}
+
+const char* CageHistory::KindName(Kind kind)
+{
+	switch (kind)
+	{
+	case Move:
+		return "move";
+	case Insert:
+		return "insert points";
+	default:
+		return "rebuild cage";
+	}
+}
+
+void CageHistory::PushMove(const std::vector<int>& ids, const Point& delta, bool adjust)
+{
+	Step step;
+	step.kind = Move;
+	step.epoch = m_Current;
+	step.adjust = adjust;
+	step.ids = ids;
+	step.delta = delta;
+	Push(std::move(step));
+}
+
+void CageHistory::PushInsert(int index, const std::vector<Point>& points)
+{
+	Step step;
+	step.kind = Insert;
+	step.epoch = m_Current;
+	step.index = index;
+	step.points = points;
+	Push(std::move(step));
+}
+
+void CageHistory::PushRebuild(const CageState& before, const CageState& after)
+{
+	Step step;
+	step.kind = Rebuild;
+	step.before = before;
+	step.after = after;
+	Push(std::move(step));
+}
+
+void CageHistory::Push(Step&& step)
+{
+	m_Redo.clear();
+	m_Undo.push_back(std::move(step));
+	if (int(m_Undo.size()) > kMaxSteps)
+		m_Undo.pop_front();
+	Prune(-1);
+}
+
+const CageHistory::Step* CageHistory::Undo(void)
+{
+	if (m_Undo.empty())
+		return nullptr;
+	m_Redo.push_back(std::move(m_Undo.back()));
+	m_Undo.pop_back();
+	return &m_Redo.back();
+}
+
+const CageHistory::Step* CageHistory::Redo(void)
+{
+	if (m_Redo.empty())
+		return nullptr;
+	m_Undo.push_back(std::move(m_Redo.back()));
+	m_Redo.pop_back();
+	return &m_Undo.back();
+}
+
+CageHistory::Epoch& CageHistory::Retire(const Point* rest, int n)
+{
+	//new weights: the steps that were undone cannot be redone on them
+	m_Redo.clear();
+	int retired = m_Current;
+	Epoch& slot = m_Cache[retired];
+	slot = Epoch();
+	slot.rest.swap(m_Rest);
+	m_Rest.assign(rest, rest + n);
+	m_Current = m_Next++;
+	//the slot is filled by the caller and referred to by the next rebuild step
+	Prune(retired);
+	return slot;
+}
+
+CageHistory::Epoch& CageHistory::Switch(int epoch)
+{
+	Epoch target = std::move(m_Cache[epoch]);
+	m_Cache.erase(epoch);
+	Epoch& slot = m_Cache[m_Current];
+	slot = std::move(target);
+	slot.rest.swap(m_Rest);
+	m_Current = epoch;
+	return slot;
+}
+
+void CageHistory::Prune(int keep)
+{
+	for (;;)
+	{
+		std::set<int> used;
+		auto add = [&](const Step& step) {
+			used.insert(step.TargetEpoch(true));
+			used.insert(step.TargetEpoch(false));
+		};
+		for (const auto& step : m_Undo)
+		{
+			add(step);
+		}
+		for (const auto& step : m_Redo)
+		{
+			add(step);
+		}
+		for (auto it = m_Cache.begin(); it != m_Cache.end();)
+		{
+			if (it->first != keep && !used.count(it->first))
+				it = m_Cache.erase(it);
+			else
+				++it;
+		}
+		if (int(m_Cache.size()) <= kMaxEpochs)
+			return;
+		//too many weight matrices: forget the oldest steps
+		if (!m_Undo.empty())
+			m_Undo.pop_front();
+		else
+			m_Redo.clear();
+	}
+}
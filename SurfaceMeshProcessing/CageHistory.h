@@ -0,0 +1,84 @@
+#pragma once
+#include <deque>
+#include <map>
+#include <vector>
+#include "MeshDefinition.h"
+
+// Undo/redo of cage edits without copies of the mesh. A drag records the moved control points
+// and their total offset, an insertion the inserted points; only edits that rebuild the cage
+// (degree changes, replaced cages) keep its control points before and after, a few dozen points.
+// The mesh of a state is re-evaluated from the weights the state was edited with. Every weight
+// computation begins an epoch: the weights in use, with the vertices they pin and the rest pose
+// they were computed on, are moved (not copied) into a cache while steps still refer to them, and
+// moved back when undo or redo crosses into their epoch, so no weights are computed again.
+class CageHistory
+{
+public:
+	typedef Mesh::Point Point;
+	static const int kMaxSteps = 1000;
+	static const int kMaxEpochs = 3;//cached weights besides the ones in use
+
+	enum Kind { Move, Insert, Rebuild };
+	struct CageState {
+		std::vector<Point> ccPoints;
+		int degree = 0, todegree = 0;
+		bool highdegree = false, usecvm = false;
+		int epoch = 0;
+	};
+	struct Step {
+		Kind kind = Move;
+		int epoch = 0;//of moves and insertions, a rebuild has one per state
+		bool adjust = false;//the cage was adjusted without deforming the mesh
+		std::vector<int> ids;//moved control points
+		Point delta;
+		int index = 0;//of the first inserted point
+		std::vector<Point> points;
+		CageState before, after;
+
+		int TargetEpoch(bool undo) const { return kind != Rebuild ? epoch : undo ? before.epoch : after.epoch; }
+	};
+	// what belongs to one set of weights, swapped with the members of the viewer
+	struct Epoch {
+		WeightMatrix weights, weightsDx, weightsDy;
+		std::vector<int> pinned;
+		std::vector<Point> pinnedRest;
+		std::vector<Point> rest;
+	};
+
+public:
+	// drops the steps and the cached weights, the epoch in use stays
+	void Clear(void);
+	int CurrentEpoch() const { return m_Current; }
+	// rest pose of the epoch in use
+	const std::vector<Point>& Rest() const { return m_Rest; }
+	int UndoCount() const { return int(m_Undo.size()); }
+	int RedoCount() const { return int(m_Redo.size()); }
+	static const char* KindName(Kind kind);
+
+	void PushMove(const std::vector<int>& ids, const Point& delta, bool adjust);
+	void PushInsert(int index, const std::vector<Point>& points);
+	void PushRebuild(const CageState& before, const CageState& after);
+
+	// the returned step stays valid until the history changes; null when there is none
+	const Step* Undo(void);
+	const Step* Redo(void);
+
+	// before new weights are computed on the rest pose: begins a new epoch and returns the cache
+	// slot of the one in use, the caller swaps its weights into it
+	Epoch& Retire(const Point* rest, int n);
+	// returns the slot holding the weights of the epoch, which becomes the one in use; the caller
+	// swaps them with its own, which are kept in the slot for the epoch it leaves
+	Epoch& Switch(int epoch);
+
+private:
+	void Push(Step&& step);
+	void Prune(int keep);
+
+private:
+	std::deque<Step> m_Undo;
+	std::vector<Step> m_Redo;
+	std::map<int, Epoch> m_Cache;
+	int m_Current = 0;
+	int m_Next = 1;
+	std::vector<Point> m_Rest;
+};
@@ -0,0 +1,75 @@
+#include "CageLayers.h"
+#include <algorithm>
+#include <cassert>
+#include "CageGeometry.h"
+
+int CageLayers::Add(const std::string& name, const Mesh& mesh, unsigned int texture)
+{
+	Layer layer;
+	layer.name = name;
+	layer.mesh = mesh;
+	layer.texture = texture;
+	m_Layers.push_back(std::move(layer));
+	m_Bound = false;
+	return Count() - 1;
+}
+
+void CageLayers::Clear(void)
+{
+	m_Layers.clear();
+	m_First.clear();
+	m_Bound = false;
+	m_Weights.resize(0, 0);
+	m_Points.clear();
+	m_Pinned.clear();
+	m_PinnedRest.clear();
+}
+
+void CageLayers::Bind(const std::vector<std::vector<Point>>& bezierCage, const WeightFunction& weigh)
+{
+	m_First.assign(1, 0);
+	for (const auto& layer : m_Layers)
+	{
+		m_First.push_back(m_First.back() + int(layer.mesh.n_vertices()));
+	}
+	int n = m_First.back();
+	m_Points.resize(n);
+	for (int l = 0; l < Count(); l++)
+	{
+		const Mesh& mesh = m_Layers[l].mesh;
+		std::copy(mesh.points(), mesh.points() + mesh.n_vertices(), m_Points.begin() + m_First[l]);
+	}
+
+	std::vector<char> side;
+	CageGeometry::classifyPoints(bezierCage, m_Points.data(), n, side);
+	m_Pinned.clear();
+	m_PinnedRest.clear();
+	for (int i = 0; i < n; i++)
+	{
+		if (side[i] == CageGeometry::Inside)
+			continue;
+		m_Pinned.push_back(i);
+		m_PinnedRest.push_back(m_Points[i]);
+	}
+
+	// all layers in one call, threads share the stacked vertices
+	weigh(m_Points.data(), n, m_Weights);
+	m_Bound = true;
+	std::cout << "layers: " << Count() << " layers, " << n << " vertices bound, " << m_Pinned.size() << " outside the cage" << std::endl;
+}
+
+void CageLayers::Deform(const Eigen::Ref<const Eigen::MatrixXd>& coeffs)
+{
+	if (!m_Bound || m_Points.empty())
+		return;
+	assert(coeffs.rows() == m_Weights.cols());
+	CageDeformer::Product(m_Weights, coeffs, m_Points.data());
+	for (int i = 0; i < int(m_Pinned.size()); i++)
+	{
+		m_Points[m_Pinned[i]] = m_PinnedRest[i];
+	}
+	for (int l = 0; l < Count(); l++)
+	{
+		std::copy(m_Points.begin() + m_First[l], m_Points.begin() + m_First[l + 1], m_Layers[l].mesh.points());
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "CageDeformer.h"
+
+// Further planar meshes (backgrounds, decals, ...) under the cage of the viewer. The vertices
+// of all layers are stacked into one array: Bind() builds their weights in one batch with the
+// weight function of the viewer, so the rows have the same columns as the mesh weights, and
+// Deform() runs one product of the stacked rows with the coefficients the viewer already has
+// for the mesh (its CageDeformer, or the worker's frame) before copying each layer's slice into
+// its mesh. The layers convert no control points of their own. Vertices outside the cage keep
+// their positions. The textures are owned by the caller.
+class CageLayers
+{
+public:
+	typedef Mesh::Point Point;
+	// fills W (n rows, one column per coefficient row) for the n points, as the mesh weights
+	typedef std::function<void(const Point* pts, int n, WeightMatrix& W)> WeightFunction;
+	struct Layer {
+		std::string name;
+		Mesh mesh;
+		unsigned int texture = 0;
+	};
+
+public:
+	// the new layer is unbound until the next Bind()
+	int Add(const std::string& name, const Mesh& mesh, unsigned int texture);
+	void Clear(void);
+	int Count() const { return int(m_Layers.size()); }
+	bool Empty() const { return m_Layers.empty(); }
+	const Layer& GetLayer(int i) const { return m_Layers[i]; }
+
+	// weights of all layers with the cage (closed Bezier segments) as it is now, which becomes the
+	// rest cage of the layers
+	void Bind(const std::vector<std::vector<Point>>& bezierCage, const WeightFunction& weigh);
+	bool Bound(int columns) const { return m_Bound && m_Weights.cols() == columns; }
+	// deforms every layer for the coefficients of the current pose (Columns() rows, see
+	// CageDeformer::Coefficients)
+	void Deform(const Eigen::Ref<const Eigen::MatrixXd>& coeffs);
+
+private:
+	std::vector<Layer> m_Layers;
+	std::vector<int> m_First;//first stacked row of every layer, plus the total at the end
+	bool m_Bound = false;
+	WeightMatrix m_Weights;
+	std::vector<Point> m_Points;//stacked positions
+	std::vector<int> m_Pinned;
+	std::vector<Point> m_PinnedRest;
+};
@@ -0,0 +1,70 @@
+#include "CageMap.h"
+#include <algorithm>
+#include <cassert>
+
+void CageMap::SetRestCage(const Cage& rest)
+{
+	m_Rest = rest.Monomial();
+	m_Deformer.Reset(rest, CageDeformer::PowerBasis);
+}
+
+void CageMap::SetCage(const Cage& cage)
+{
+	m_Deformer.Update(cage);
+}
+
+void CageMap::Apply(const double* W, int n, const double* z, int zStride, Point* out) const
+{
+	int K = Columns();
+	Eigen::Map<const WeightMatrix> w(W, n, K);
+	Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>, 0, Eigen::OuterStride<3>> xy(out->data(), n, 2);
+	xy.noalias() = w * m_Deformer.Coefficients();
+	for (int k = 0; k < n; k++)
+	{
+		out[k][2] = z[k * zStride];
+	}
+}
+
+void CageMap::Evaluate(const Point* pts, int nPts, Point* out) const
+{
+	int K = Columns();
+	int nChunks = (nPts + kChunk - 1) / kChunk;
+#pragma omp parallel
+	{
+		std::vector<double> W(std::size_t(kChunk) * K);
+		// cageWeights runs on the calling thread here, nested parallelism is off
+#pragma omp for schedule(dynamic)
+		for (int c = 0; c < nChunks; c++)
+		{
+			int first = c * kChunk;
+			int n = std::min(int(kChunk), nPts - first);
+			GreenCoords::cageWeights(m_Rest, pts + first, n, W.data(), K);
+			Apply(W.data(), n, pts[first].data() + 2, 3, out + first);
+		}
+	}
+}
+
+void CageMap::BuildCache(const Point* pts, int nPts, Cache& cache) const
+{
+	cache.weights.resize(nPts, Columns());
+	GreenCoords::cageWeights(m_Rest, pts, nPts, cache.weights.data(), Columns());
+	cache.z.resize(nPts);
+	for (int k = 0; k < nPts; k++)
+	{
+		cache.z[k] = pts[k][2];
+	}
+}
+
+void CageMap::Evaluate(const Cache& cache, Point* out) const
+{
+	assert(cache.weights.cols() == Columns());
+	int nPts = int(cache.weights.rows());
+	int nChunks = (nPts + kChunk - 1) / kChunk;
+#pragma omp parallel for schedule(static)
+	for (int c = 0; c < nChunks; c++)
+	{
+		int first = c * kChunk;
+		int n = std::min(int(kChunk), nPts - first);
+		Apply(cache.weights.row(first).data(), n, cache.z.data() + first, 1, out + first);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include "MeshDefinition.h"
+#include "GreenCoords.h"
+#include "Cage.h"
+#include "CageDeformer.h"
+
+// Green coordinate map of a polynomial cage, evaluated at arbitrary points without a mesh.
+// The weights of a point depend on the rest cage only, the current cage gives the coefficients
+// they multiply: f(eta) = sum_k w_k(eta) C_k, with C the PowerBasis rows of a CageDeformer
+// following the current cage, the layout of GreenCoords::segmentWeights. Points keep their z.
+// Weights are meaningful inside the rest cage only (see CageGeometry::classifyPoints).
+class CageMap
+{
+public:
+	typedef GreenCoords::Point Point;
+	// points per chunk of the on-the-fly evaluation, every thread holds one chunk of weights
+	static const int kChunk = 256;
+
+	// weights of a point set that is mapped again after every change of the cage
+	struct Cache {
+		WeightMatrix weights;
+		std::vector<double> z;
+	};
+
+public:
+	// also makes it the current cage
+	void SetRestCage(const Cage& rest);
+	// the rest cage as edited since (same layout), only segments with a new version are taken over
+	void SetCage(const Cage& cage);
+	int Columns() const { return m_Deformer.Columns(); }
+
+	// images of nPts points, weights computed on the fly chunk by chunk; out may be pts
+	void Evaluate(const Point* pts, int nPts, Point* out) const;
+	void BuildCache(const Point* pts, int nPts, Cache& cache) const;
+	// images of the cached points, out has cache.weights.rows() entries
+	void Evaluate(const Cache& cache, Point* out) const;
+
+private:
+	void Apply(const double* W, int n, const double* z, int zStride, Point* out) const;
+
+private:
+	Cage::SegmentList m_Rest;//power basis of the rest cage, read by the weights of every chunk
+	CageDeformer m_Deformer;
+};
@@ -0,0 +1,111 @@
+#include "DeformWorker.h"
+
+void DeformWorker::Start(const WeightMatrix& weights, const WeightMatrix* weightsDx, const WeightMatrix* weightsDy,
+	const Cage& cage, CageDeformer::Basis basis,
+	const Point* points, int nPoints, const std::vector<int>& pinned, std::function<void()> published)
+{
+	Stop();
+	m_Weights = &weights;
+	m_WeightsDx = weightsDx && weightsDy ? weightsDx : nullptr;
+	m_WeightsDy = weightsDx && weightsDy ? weightsDy : nullptr;
+	m_Cage = cage;
+	m_Deformer.Reset(m_Cage, basis);
+	m_Work.assign(points, points + nPoints);
+	m_WorkDx.resize(m_WeightsDx ? nPoints : 0, 2);
+	m_WorkDy.resize(m_WeightsDy ? nPoints : 0, 2);
+	m_Pinned = pinned;
+	m_PinnedRest.resize(pinned.size());
+	for (int i = 0; i < int(pinned.size()); i++)
+	{
+		m_PinnedRest[i] = points[pinned[i]];
+	}
+	m_Published = published;
+	m_Poses.Clear();
+	m_Frames.Clear();
+	for (int i = 0; i < 3; i++)
+	{
+		m_Poses.Buffer(i) = cage.Points();
+		Frame& f = m_Frames.Buffer(i);
+		f.points = m_Work;
+		f.jacobianDx.resize(m_WorkDx.rows(), 2);
+		f.jacobianDy.resize(m_WorkDy.rows(), 2);
+		f.coeffs = m_Deformer.Coefficients();
+		f.cage = cage.Points();
+	}
+	m_Stop = false;
+	m_Thread = std::thread(&DeformWorker::Run, this);
+}
+
+void DeformWorker::Stop(void)
+{
+	if (!m_Thread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Stop = true;
+	}
+	m_Wake.notify_one();
+	m_Thread.join();
+}
+
+void DeformWorker::Post(const std::vector<Point>& ccPoints)
+{
+	if (!Running())
+		return;
+	m_Poses.Back() = ccPoints;//same size as in Start, no allocation
+	m_Poses.Publish();
+	// taking the mutex orders the publish before the worker's wait, so the wake-up is not lost
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+	}
+	m_Wake.notify_one();
+}
+
+void DeformWorker::Run(void)
+{
+	std::unique_lock<std::mutex> lock(m_WakeMutex);
+	while (true)
+	{
+		m_Wake.wait(lock, [this] { return m_Stop || m_Poses.HasNew(); });
+		if (!m_Poses.HasNew())
+			break;
+		lock.unlock();
+		m_Poses.Acquire();
+		m_Cage.SetPoints(m_Poses.Front());
+		m_Deformer.Update(m_Cage);
+		if (m_Deformer.FullUpdateDue())
+		{
+			m_Deformer.Deform(*m_Weights, m_Work.data());
+			if (m_WeightsDx)
+			{
+				m_Deformer.Apply(*m_WeightsDx, m_WorkDx);
+				m_Deformer.Apply(*m_WeightsDy, m_WorkDy);
+			}
+		}
+		else
+		{
+			m_Deformer.DeformChanged(*m_Weights, m_Work.data());
+			if (m_WeightsDx)
+			{
+				m_Deformer.ApplyChanged(*m_WeightsDx, m_WorkDx);
+				m_Deformer.ApplyChanged(*m_WeightsDy, m_WorkDy);
+			}
+		}
+		m_Deformer.Commit();
+
+		Frame& f = m_Frames.Back();
+		f.points = m_Work;
+		for (int i = 0; i < int(m_Pinned.size()); i++)
+		{
+			f.points[m_Pinned[i]] = m_PinnedRest[i];
+		}
+		f.jacobianDx = m_WorkDx;
+		f.jacobianDy = m_WorkDy;
+		f.coeffs = m_Deformer.Coefficients();
+		f.cage = m_Poses.Front();
+		m_Frames.Publish();
+		if (m_Published)
+			m_Published();
+		lock.lock();
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CageDeformer.h"
+
+// Latest-wins single-producer/single-consumer slot over three copies of T. The producer fills
+// Back() and publishes it, the consumer takes the latest published copy with Acquire() and
+// reads it as Front() until its next Acquire(). Both sides swap indices with one atomic
+// exchange and never wait for each other; values published in between are dropped.
+template <typename T>
+class LatestSlot
+{
+public:
+	T& Buffer(int i) { return m_Buffers[i]; }//setup only, while nobody else uses the slot
+
+	T& Back() { return m_Buffers[m_Back]; }
+	void Publish(void)
+	{
+		int old = m_State.exchange(m_Back | kNew, std::memory_order_acq_rel);
+		m_Back = old & kIndex;
+	}
+
+	bool HasNew() const { return (m_State.load(std::memory_order_acquire) & kNew) != 0; }
+	bool Acquire(void)
+	{
+		if (!HasNew())
+			return false;
+		int old = m_State.exchange(m_Front, std::memory_order_acq_rel);
+		m_Front = old & kIndex;
+		return true;
+	}
+	const T& Front() const { return m_Buffers[m_Front]; }
+
+	void Clear(void)
+	{
+		m_Back = 0;
+		m_State.store(1);
+		m_Front = 2;
+	}
+
+private:
+	static const int kIndex = 3;
+	static const int kNew = 4;
+	T m_Buffers[3];
+	int m_Back = 0;//producer side
+	std::atomic<int> m_State{ 1 };//published index | kNew
+	int m_Front = 2;//consumer side
+};
+
+// Cage deformation off the GUI thread. The GUI posts the control points of every pose with
+// Post(); the worker moves its own copy of the cage to the latest pose only, deforms the mesh
+// with it (CageDeformer, incremental between full products) and publishes positions, Jacobians,
+// coefficients and control points of that pose as one Frame, which the GUI picks up when it
+// paints. All buffers are sized in Start().
+class DeformWorker
+{
+public:
+	typedef Mesh::Point Point;
+	struct Frame {
+		std::vector<Point> points;
+		Eigen::Matrix<double, Eigen::Dynamic, 2> jacobianDx;
+		Eigen::Matrix<double, Eigen::Dynamic, 2> jacobianDy;
+		Eigen::Matrix<double, Eigen::Dynamic, 2> coeffs;//of the pose, for whatever else follows the cage
+		std::vector<Point> cage;//control points of the pose, to draw the cage the mesh was deformed with
+	};
+
+public:
+	~DeformWorker() { Stop(); }
+
+	// The weight matrices are read by the worker until Stop() and must not change meanwhile;
+	// weightsDx/Dy may be null. points: current positions of the nPoints mesh vertices,
+	// pinned vertices keep them. published is called on the worker thread after each Frame.
+	void Start(const WeightMatrix& weights, const WeightMatrix* weightsDx, const WeightMatrix* weightsDy,
+		const Cage& cage, CageDeformer::Basis basis,
+		const Point* points, int nPoints, const std::vector<int>& pinned, std::function<void()> published);
+	// deforms with the last posted pose, if any is still pending, then joins the thread
+	void Stop(void);
+	bool Running() const { return m_Thread.joinable(); }
+
+	void Post(const std::vector<Point>& ccPoints);
+	bool Acquire() { return m_Frames.Acquire(); }
+	const Frame& Front() const { return m_Frames.Front(); }
+
+private:
+	void Run(void);
+
+private:
+	const WeightMatrix* m_Weights = nullptr;
+	const WeightMatrix* m_WeightsDx = nullptr;
+	const WeightMatrix* m_WeightsDy = nullptr;
+	Cage m_Cage;//at the pose being deformed
+	CageDeformer m_Deformer;
+	std::vector<Point> m_Work;//positions of the previous update before pinning, the base of the incremental one
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_WorkDx, m_WorkDy;
+	std::vector<int> m_Pinned;
+	std::vector<Point> m_PinnedRest;
+	std::function<void()> m_Published;
+
+	LatestSlot<std::vector<Point>> m_Poses;
+	LatestSlot<Frame> m_Frames;
+
+	std::thread m_Thread;
+	// only to sleep while no pose is pending, the poses themselves go through m_Poses
+	std::mutex m_WakeMutex;
+	std::condition_variable m_Wake;
+	bool m_Stop = false;
+};
@@ -0,0 +1,125 @@
+#include "DistortionMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+// conformal distortion mapped to full red
+static const double kMaxShownDistortion = 3.0;
+
+void DistortionMetrics::SetRest(const Mesh& mesh)
+{
+	int nF = int(mesh.n_faces());
+	m_Triangles.assign(3 * nF, 0);
+	m_RestInv.assign(nF, Eigen::Matrix2d::Identity());
+	for (const auto& fh : mesh.faces())
+	{
+		int i = 0;
+		for (const auto& fvh : mesh.fv_range(fh))
+		{
+			m_Triangles[3 * fh.idx() + i++] = fvh.idx();
+		}
+		const auto& p0 = mesh.point(mesh.vertex_handle(m_Triangles[3 * fh.idx()]));
+		const auto& p1 = mesh.point(mesh.vertex_handle(m_Triangles[3 * fh.idx() + 1]));
+		const auto& p2 = mesh.point(mesh.vertex_handle(m_Triangles[3 * fh.idx() + 2]));
+		Eigen::Matrix2d E;
+		E << p1[0] - p0[0], p2[0] - p0[0],
+			p1[1] - p0[1], p2[1] - p0[1];
+		if (E.determinant() != 0)
+			m_RestInv[fh.idx()] = E.inverse();
+	}
+	m_LastPoints.assign(mesh.points(), mesh.points() + mesh.n_vertices());
+	m_Moved.assign(mesh.n_vertices(), 0);
+	m_Distortion.assign(nF, 1.0);
+	m_AreaRatio.assign(nF, 1.0);
+	m_Flipped.assign(nF, 0);
+	m_Colors.assign(4 * nF, 1.0f);
+	for (int f = 0; f < nF; f++)
+	{
+		m_Colors[4 * f + 3] = 0.0f;
+	}
+	Summarize();
+}
+
+bool DistortionMetrics::Update(const Mesh& mesh)
+{
+	if (m_LastPoints.size() != mesh.n_vertices() || m_Distortion.size() != mesh.n_faces())
+	{
+		SetRest(mesh);
+		return true;
+	}
+	const Mesh::Point* pts = mesh.points();
+	int nV = int(mesh.n_vertices());
+	int nF = FaceCount();
+	int nMoved = 0;
+#pragma omp parallel for reduction(+:nMoved)
+	for (int v = 0; v < nV; v++)
+	{
+		m_Moved[v] = pts[v] != m_LastPoints[v];
+		if (m_Moved[v])
+		{
+			m_LastPoints[v] = pts[v];
+			nMoved++;
+		}
+	}
+	if (nMoved == 0)
+		return false;
+#pragma omp parallel for schedule(static)
+	for (int f = 0; f < nF; f++)
+	{
+		const int* t = &m_Triangles[3 * f];
+		if (m_Moved[t[0]] || m_Moved[t[1]] || m_Moved[t[2]])
+			EvaluateFace(f, pts);
+	}
+	Summarize();
+	return true;
+}
+
+void DistortionMetrics::EvaluateFace(int f, const Mesh::Point* pts)
+{
+	const int* t = &m_Triangles[3 * f];
+	const auto& p0 = pts[t[0]];
+	const auto& p1 = pts[t[1]];
+	const auto& p2 = pts[t[2]];
+	Eigen::Matrix2d D;
+	D << p1[0] - p0[0], p2[0] - p0[0],
+		p1[1] - p0[1], p2[1] - p0[1];
+	Eigen::Matrix2d J = D * m_RestInv[f];
+	// closed form singular values of a 2x2 matrix, sigma2 carries the sign of det(J)
+	double E = (J(0, 0) + J(1, 1)) / 2, F = (J(0, 0) - J(1, 1)) / 2;
+	double G = (J(1, 0) + J(0, 1)) / 2, H = (J(1, 0) - J(0, 1)) / 2;
+	double Q = std::sqrt(E * E + H * H), R = std::sqrt(F * F + G * G);
+	double sigma1 = Q + R, sigma2 = Q - R;
+	double det = J.determinant();
+	m_AreaRatio[f] = det;
+	m_Flipped[f] = det <= 0;
+	m_Distortion[f] = sigma2 > 0 ? sigma1 / sigma2 : INFINITY;
+
+	float* c = &m_Colors[4 * f];
+	if (m_Flipped[f])
+	{
+		c[0] = 0.1f; c[1] = 0.2f; c[2] = 1.0f; c[3] = 0.8f;
+		return;
+	}
+	double s = std::min(1.0, std::log(m_Distortion[f]) / std::log(kMaxShownDistortion));
+	c[0] = 1.0f;
+	c[1] = float(1 - s);
+	c[2] = float(1 - s);
+	c[3] = float(0.7 * s);
+}
+
+void DistortionMetrics::Summarize(void)
+{
+	m_Summary = Summary();
+	for (int f = 0; f < FaceCount(); f++)
+	{
+		if (m_Flipped[f])
+		{
+			m_Summary.flipped++;
+			continue;
+		}
+		m_Summary.maxDistortion = std::max(m_Summary.maxDistortion, m_Distortion[f]);
+		m_Summary.minAreaRatio = std::min(m_Summary.minAreaRatio, m_AreaRatio[f]);
+		m_Summary.maxAreaRatio = std::max(m_Summary.maxAreaRatio, m_AreaRatio[f]);
+	}
+	if (m_Summary.flipped == FaceCount())
+		m_Summary.minAreaRatio = m_Summary.maxAreaRatio = 0.0;
+}
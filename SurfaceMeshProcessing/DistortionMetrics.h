@@ -0,0 +1,48 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include "MeshDefinition.h"
+
+// Per-triangle distortion of a deformed mesh with respect to its rest pose (x/y only).
+// For the affine map J of each triangle it keeps the conformal distortion sigma1/sigma2,
+// the area ratio det(J) and whether the triangle is inverted (det(J) <= 0). Update() only
+// re-evaluates triangles touching vertices that moved since the last call, in parallel,
+// and refreshes the cached heatmap colors of those triangles.
+class DistortionMetrics
+{
+public:
+	struct Summary {
+		double maxDistortion = 1.0;
+		// over the triangles that are not inverted, both 0 when every triangle is
+		double minAreaRatio = INFINITY;
+		double maxAreaRatio = -INFINITY;
+		int flipped = 0;
+	};
+
+public:
+	// rest pose and face list; all metrics are reset to the identity
+	void SetRest(const Mesh& mesh);
+	// returns false when no vertex moved, so nothing (including the colors) changed
+	bool Update(const Mesh& mesh);
+
+	int FaceCount() const { return int(m_Distortion.size()); }
+	const int* Triangles() const { return m_Triangles.data(); }
+	// RGBA per face, red for increasing conformal distortion, blue for inverted triangles
+	const float* FaceColors() const { return m_Colors.data(); }
+	const Summary& GetSummary() const { return m_Summary; }
+
+private:
+	void EvaluateFace(int f, const Mesh::Point* pts);
+	void Summarize(void);
+
+private:
+	std::vector<int> m_Triangles;
+	std::vector<Eigen::Matrix2d> m_RestInv;
+	std::vector<Mesh::Point> m_LastPoints;
+	std::vector<char> m_Moved;
+	std::vector<double> m_Distortion;
+	std::vector<double> m_AreaRatio;
+	std::vector<char> m_Flipped;
+	std::vector<float> m_Colors;
+	Summary m_Summary;
+};
@@ -0,0 +1,309 @@
+#include "DragSession.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	const char kSessionMagic[4] = { 'P', 'G', 'C', 'S' };
+	const char kWeightsMagic[4] = { 'P', 'G', 'C', 'W' };
+	const std::uint32_t kVersion = 1;
+
+	template <typename T>
+	void put(std::ostream& out, const T& value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool get(std::istream& in, T& value)
+	{
+		return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	bool magic(std::istream& in, const char (&expected)[4])
+	{
+		char m[4];
+		return in.read(m, 4) && std::memcmp(m, expected, 4) == 0;
+	}
+
+	// nearest rank of the sorted values
+	double percentile(const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty())
+			return 0;
+		int k = int(std::ceil(p * sorted.size())) - 1;
+		return sorted[std::min(std::max(k, 0), int(sorted.size()) - 1)];
+	}
+}
+
+void DragSession::Begin(const std::string& meshFile, int nVertices, const std::vector<Point>& ccPoints, int degree, CageDeformer::Basis basis)
+{
+	m_MeshFile = meshFile;
+	m_nVertices = nVertices;
+	m_CCPoints = ccPoints;
+	m_Degree = degree;
+	m_Basis = basis;
+	m_Events.clear();
+	m_Last = std::chrono::steady_clock::now();
+	m_Recording = true;
+}
+
+void DragSession::Record(Kind kind, const int* ids, int n, const Point& delta)
+{
+	if (!m_Recording)
+		return;
+	auto now = std::chrono::steady_clock::now();
+	auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - m_Last).count();
+	m_Last = now;
+	Event e;
+	e.kind = kind;
+	e.micros = std::uint32_t(std::min<long long>(micros, UINT32_MAX));
+	e.ids.assign(ids, ids + n);
+	e.dx = delta[0];
+	e.dy = delta[1];
+	m_Events.push_back(std::move(e));
+}
+
+bool DragSession::Save(const std::string& filename, const WeightMatrix& weights, const std::vector<int>& pinned) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	std::ofstream outWeights(filename + ".weights", std::ios::binary);
+	if (!out || !outWeights)
+	{
+		std::cerr << "ERROR: cannot write session " << filename << std::endl;
+		return false;
+	}
+	out.write(kSessionMagic, 4);
+	put(out, kVersion);
+	put(out, std::uint32_t(m_MeshFile.size()));
+	out.write(m_MeshFile.data(), m_MeshFile.size());
+	put(out, std::uint32_t(m_nVertices));
+	put(out, std::int32_t(m_Degree));
+	put(out, std::int32_t(m_Basis));
+	put(out, std::uint32_t(m_CCPoints.size()));
+	for (const auto& p : m_CCPoints)
+	{
+		put(out, p);
+	}
+	put(out, std::uint32_t(m_Events.size()));
+	for (const auto& e : m_Events)
+	{
+		put(out, e.kind);
+		put(out, e.micros);
+		if (e.kind == Press)
+		{
+			put(out, std::uint32_t(e.ids.size()));
+			out.write(reinterpret_cast<const char*>(e.ids.data()), e.ids.size() * sizeof(std::uint32_t));
+		}
+		else if (e.kind == Move)
+		{
+			put(out, e.dx);
+			put(out, e.dy);
+		}
+	}
+
+	outWeights.write(kWeightsMagic, 4);
+	put(outWeights, std::uint32_t(weights.rows()));
+	put(outWeights, std::uint32_t(weights.cols()));
+	outWeights.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(double));
+	put(outWeights, std::uint32_t(pinned.size()));
+	outWeights.write(reinterpret_cast<const char*>(pinned.data()), pinned.size() * sizeof(int));
+	return bool(out) && bool(outWeights);
+}
+
+bool DragSession::Load(const std::string& filename, WeightMatrix& weights, std::vector<int>& pinned)
+{
+	m_Recording = false;
+	m_Events.clear();
+	std::ifstream in(filename, std::ios::binary);
+	std::ifstream inWeights(filename + ".weights", std::ios::binary);
+	if (!in || !inWeights)
+	{
+		std::cerr << "ERROR: cannot open session " << filename << " and its weights" << std::endl;
+		return false;
+	}
+	std::uint32_t version = 0, length = 0, nVertices = 0, nPoints = 0, nEvents = 0;
+	std::int32_t degree = 0, basis = 0;
+	if (!magic(in, kSessionMagic) || !get(in, version) || version != kVersion || !get(in, length))
+	{
+		std::cerr << "ERROR: " << filename << " is not a drag session" << std::endl;
+		return false;
+	}
+	m_MeshFile.resize(length);
+	in.read(&m_MeshFile[0], length);
+	get(in, nVertices);
+	get(in, degree);
+	get(in, basis);
+	get(in, nPoints);
+	m_nVertices = int(nVertices);
+	m_Degree = degree;
+	m_Basis = CageDeformer::Basis(basis);
+	m_CCPoints.resize(in ? nPoints : 0);
+	for (auto& p : m_CCPoints)
+	{
+		get(in, p);
+	}
+	bool ok = get(in, nEvents);
+	for (std::uint32_t i = 0; ok && i < nEvents; i++)
+	{
+		Event e;
+		e.dx = e.dy = 0;
+		ok = get(in, e.kind) && get(in, e.micros);
+		if (ok && e.kind == Press)
+		{
+			std::uint32_t n = 0;
+			ok = get(in, n) && n <= nPoints;
+			if (ok)
+			{
+				e.ids.resize(n);
+				ok = bool(in.read(reinterpret_cast<char*>(e.ids.data()), n * sizeof(std::uint32_t)));
+				ok = ok && std::all_of(e.ids.begin(), e.ids.end(), [&](std::uint32_t id) { return id < nPoints; });
+			}
+		}
+		else if (ok && e.kind == Move)
+		{
+			ok = get(in, e.dx) && get(in, e.dy);
+		}
+		ok = ok && e.kind <= Release;
+		if (ok)
+			m_Events.push_back(std::move(e));
+	}
+	if (!ok)
+	{
+		std::cerr << "ERROR: truncated or corrupt session " << filename << std::endl;
+		return false;
+	}
+
+	std::uint32_t rows = 0, cols = 0, nPinned = 0;
+	ok = magic(inWeights, kWeightsMagic) && get(inWeights, rows) && get(inWeights, cols) && rows == nVertices;
+	if (ok)
+	{
+		weights.resize(rows, cols);
+		ok = bool(inWeights.read(reinterpret_cast<char*>(weights.data()), weights.size() * sizeof(double)));
+	}
+	ok = ok && get(inWeights, nPinned) && nPinned <= rows;
+	if (ok)
+	{
+		pinned.resize(nPinned);
+		ok = bool(inWeights.read(reinterpret_cast<char*>(pinned.data()), nPinned * sizeof(int)));
+		ok = ok && std::all_of(pinned.begin(), pinned.end(), [&](int v) { return v >= 0 && v < int(rows); });
+	}
+	if (!ok)
+	{
+		std::cerr << "ERROR: weights of " << filename << " do not match the session" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool DragSession::Replay(const WeightMatrix& weights, const std::vector<int>& pinned, Mesh& mesh, Report& report) const
+{
+	if (weights.rows() != Eigen::Index(mesh.n_vertices()) || int(mesh.n_vertices()) != m_nVertices)
+	{
+		std::cerr << "ERROR: the mesh has " << mesh.n_vertices() << " vertices, the session " << m_nVertices << std::endl;
+		return false;
+	}
+	std::vector<Point> pinnedRest(pinned.size());
+	for (int i = 0; i < int(pinned.size()); i++)
+	{
+		pinnedRest[i] = mesh.points()[pinned[i]];
+	}
+	Cage cage;
+	cage.Reset(m_CCPoints, m_Degree);
+	std::vector<int> moving;
+	CageDeformer deformer;
+	bool pressed = false;
+	std::vector<double> ms;
+	ms.reserve(m_Events.size());
+	report = Report();
+	for (const auto& e : m_Events)
+	{
+		report.recordedMs += e.micros * 1e-3;
+		if (e.kind == Press)
+		{
+			moving.assign(e.ids.begin(), e.ids.end());
+			deformer.Reset(cage, m_Basis);
+			if (weights.cols() != deformer.Columns())
+			{
+				std::cerr << "ERROR: the weights do not match the cage" << std::endl;
+				return false;
+			}
+			pressed = true;
+		}
+		else if (e.kind == Release)
+		{
+			pressed = false;
+		}
+		else if (pressed)
+		{
+			auto start = std::chrono::steady_clock::now();
+			cage.MovePoints(moving.data(), int(moving.size()), Point(e.dx, e.dy, 0));
+			deformer.Update(cage);
+			if (deformer.FullUpdateDue())
+				deformer.Deform(weights, mesh.points());
+			else
+				deformer.DeformChanged(weights, mesh.points());
+			deformer.Commit();
+			for (int i = 0; i < int(pinned.size()); i++)
+			{
+				mesh.points()[pinned[i]] = pinnedRest[i];
+			}
+			ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+	}
+	std::sort(ms.begin(), ms.end());
+	report.moves = int(ms.size());
+	report.p50 = percentile(ms, 0.50);
+	report.p95 = percentile(ms, 0.95);
+	report.p99 = percentile(ms, 0.99);
+	report.max = ms.empty() ? 0 : ms.back();
+	report.checksum = Checksum(mesh);
+	return true;
+}
+
+bool DragSession::ReplayFile(const std::string& filename)
+{
+	DragSession session;
+	WeightMatrix weights;
+	std::vector<int> pinned;
+	if (!session.Load(filename, weights, pinned))
+		return false;
+	// read as the viewer reads it, so that the vertices are in the order of the weight rows
+	Mesh mesh;
+	std::vector<int> vertexOrder;
+	if (!MeshTools::ReadMesh(mesh, session.MeshFile(), &vertexOrder))
+	{
+		std::cerr << "ERROR: cannot read mesh " << session.MeshFile() << std::endl;
+		return false;
+	}
+	Report report;
+	if (!session.Replay(weights, pinned, mesh, report))
+		return false;
+	std::cout << "replay " << filename << ": " << session.Events() << " events, " << report.moves << " moves over "
+		<< report.recordedMs << " ms recorded" << std::endl;
+	std::cout << "deformation per move: p50 " << report.p50 << " ms, p95 " << report.p95 << " ms, p99 " << report.p99
+		<< " ms, max " << report.max << " ms" << std::endl;
+	std::cout << "checksum " << std::hex << report.checksum << std::dec << std::endl;
+	return true;
+}
+
+std::uint64_t DragSession::Checksum(const Mesh& mesh)
+{
+	std::uint64_t h = 14695981039346656037ull;
+	for (int i = 0; i < int(mesh.n_vertices()); i++)
+	{
+		const Point& p = mesh.points()[i];
+		for (int k = 0; k < 3; k++)
+		{
+			std::int64_t q = std::llround(p[k] * 1e9);
+			for (int b = 0; b < 8; b++)
+			{
+				h ^= std::uint64_t(q >> (8 * b)) & 0xff;
+				h *= 1099511628211ull;
+			}
+		}
+	}
+	return h;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CageDeformer.h"
+
+// Cage drags recorded for replay. A session starts from a cage (control points, degree, basis)
+// over a mesh file and logs every press (the picked control points), move (delta of the picked
+// points) and release with its time. Save() writes the events to a compact binary file and the
+// weights the drags were deformed with, plus the pinned vertices, to <file>.weights, so that
+// Replay() can run the same drags through CageDeformer without the viewer, e.g. from
+//   SurfaceMeshProcessing --replay session.pgcs
+class DragSession
+{
+public:
+	typedef Mesh::Point Point;
+	enum Kind : std::uint8_t {
+		Press,
+		Move,
+		Release
+	};
+	struct Event {
+		Kind kind;
+		std::uint32_t micros;//since the previous event
+		std::vector<std::uint32_t> ids;//Press only
+		double dx, dy;//Move only
+	};
+	struct Report {
+		int moves = 0;
+		double p50 = 0, p95 = 0, p99 = 0, max = 0;//deformation time per move, ms
+		double recordedMs = 0;
+		std::uint64_t checksum = 0;
+	};
+
+public:
+	void Begin(const std::string& meshFile, int nVertices, const std::vector<Point>& ccPoints, int degree, CageDeformer::Basis basis);
+	void Record(Kind kind, const int* ids = nullptr, int n = 0, const Point& delta = Point(0, 0, 0));
+	void End(void) { m_Recording = false; }
+	bool Recording() const { return m_Recording; }
+	int Events() const { return int(m_Events.size()); }
+
+	bool Save(const std::string& filename, const WeightMatrix& weights, const std::vector<int>& pinned) const;
+	bool Load(const std::string& filename, WeightMatrix& weights, std::vector<int>& pinned);
+	const std::string& MeshFile() const { return m_MeshFile; }
+
+	// every move deforms the mesh as the viewer's drag does (incremental between full products,
+	// pinned vertices kept), one deformation per move rather than per painted frame
+	bool Replay(const WeightMatrix& weights, const std::vector<int>& pinned, Mesh& mesh, Report& report) const;
+	// loads the session, its weights and the mesh it names, replays it and prints the report
+	static bool ReplayFile(const std::string& filename);
+	// FNV-1a over the coordinates rounded to 1e-9, equal for results that differ only in the
+	// last bits (summation order, FMA)
+	static std::uint64_t Checksum(const Mesh& mesh);
+
+private:
+	bool m_Recording = false;
+	std::chrono::steady_clock::time_point m_Last;
+	std::string m_MeshFile;
+	int m_nVertices = 0;
+	int m_Degree = 0;
+	CageDeformer::Basis m_Basis = CageDeformer::PowerBasis;
+	std::vector<Point> m_CCPoints;
+	std::vector<Event> m_Events;
+};
@@ -0,0 +1,309 @@
+#include "GreenCoords.h"
+#include "ComplexMath.h"
+#include <cassert>
+namespace GreenCoords {
+	typedef std::complex<double> Complex;
+	const int kMaxDegree = 7;
+	const int kMaxMoment = 3 * kMaxDegree;
+	// a root of c(t) - eta this close to [0, 1] (in parameter units) selects nearFieldWeights
+	const double kNearField = 0.1;
+
+	inline Complex toComplex(const Point& p) {
+		return Complex(p[0], p[1]);
+	}
+	// a . arthono(b)
+	inline double cross(const Complex& a, const Complex& b) {
+		return a.real() * b.imag() - a.imag() * b.real();
+	}
+	inline double inner(const Complex& a, const Complex& b) {
+		return a.real() * b.real() + a.imag() * b.imag();
+	}
+
+	// roots of sum_{p<=e} z[p] t^p with z[e] != 0
+	static void polyRoots(const Complex* z, int e, Complex* r) {
+		if (e == 1) {
+			r[0] = -z[0] / z[1];
+			return;
+		}
+		if (e == 2) {
+			Complex disc = std::sqrt(z[1] * z[1] - 4.0 * z[2] * z[0]);
+			Complex q = std::norm(z[1] + disc) >= std::norm(z[1] - disc) ? -(z[1] + disc) / 2.0 : -(z[1] - disc) / 2.0;
+			r[0] = q / z[2];
+			r[1] = q != 0.0 ? z[0] / q : Complex(0.0);
+			return;
+		}
+		if (e == 3) {
+			// Cardano as in F3_n, polished below
+			Complex a = z[3], b = z[2], c = z[1], d = z[0];
+			Complex u = (9.0 * a * b * c - 27.0 * a * a * d - 2.0 * b * b * b) / (54.0 * a * a * a);
+			Complex v = std::sqrt(3.0 * (4.0 * a * c * c * c - b * b * c * c - 18.0 * a * b * c * d + 27.0 * a * a * d * d + 4.0 * b * b * b * d)) / (18.0 * a * a);
+			Complex m = std::norm(u + v) >= std::norm(u - v) ? std::pow(u + v, 1.0 / 3.0) : std::pow(u - v, 1.0 / 3.0);
+			Complex n = std::norm(m) != 0 ? (b * b - 3.0 * a * c) / (9.0 * a * a * m) : Complex(0.0);
+			Complex omega1(-0.5, sqrt(3.0) / 2.0);
+			Complex omega2(-0.5, -sqrt(3.0) / 2.0);
+			r[0] = m + n - b / (3.0 * a);
+			r[1] = omega1 * m + omega2 * n - b / (3.0 * a);
+			r[2] = omega2 * m + omega1 * n - b / (3.0 * a);
+		}
+		else {
+			Eigen::MatrixXcd companion = Eigen::MatrixXcd::Zero(e, e);
+			for (int p = 0; p < e; p++) {
+				companion(0, p) = -z[e - 1 - p] / z[e];
+				if (p + 1 < e) {
+					companion(p + 1, p) = 1.0;
+				}
+			}
+			Eigen::ComplexEigenSolver<Eigen::MatrixXcd> solver(companion, false);
+			for (int i = 0; i < e; i++) {
+				r[i] = solver.eigenvalues()[i];
+			}
+		}
+		for (int i = 0; i < e; i++) {
+			for (int it = 0; it < 2; it++) {
+				Complex f = z[e], df = 0.0;
+				for (int p = e - 1; p >= 0; p--) {
+					df = df * r[i] + f;
+					f = f * r[i] + z[p];
+				}
+				if (df != 0.0) {
+					r[i] -= f / df;
+				}
+			}
+		}
+	}
+
+	// I[m] = int_0^1 t^m / (t - r) dt for m = 0..M. The forward recursion multiplies errors by |r|
+	// per step, so roots far from the segment use the series -sum_j r^-(j+1) / (m + j + 1).
+	static void logMoments(const Complex& r, int M, Complex* I) {
+		if (std::abs(r) <= 1.5) {
+			I[0] = ComplexMath::KernelMath::log(1.0 - ComplexMath::KernelMath::reciprocal(r));
+			for (int m = 1; m <= M; m++) {
+				I[m] = r * I[m - 1] + 1.0 / m;
+			}
+			return;
+		}
+		Complex inv = 1.0 / r;
+		for (int m = 0; m <= M; m++) {
+			Complex sum = 0.00, pw = inv;
+			for (int j = 0; j < 200; j++) {
+				Complex term = pw / double(m + j + 1);
+				sum += term;
+				if (std::norm(term) <= 1e-34 * std::norm(sum)) {
+					break;
+				}
+				pw *= inv;
+			}
+			I[m] = -sum;
+		}
+	}
+
+	// Near-field path. With z'/z = sum_i 1/(t - r_i), phi_k and psi_k are the imaginary and real
+	// parts of 1/(2pi) int t^k z'/z dt = 1/(2pi) sum_i I1(r_i, k), with no |z|^2 in the denominator.
+	// The moment sums of segmentWeights cancel terms of size 1/|Im r_i| instead and lose that
+	// many digits as eta approaches the curve. The derivatives use d/deta_x (z'/z) = z'/z^2 and
+	// int t^k z'/z^2 dt = -[t^k/z]_0^1 + k sum_i I1(r_i, k-1) / z'(r_i).
+	static void nearFieldWeights(const Complex* z, int d, int e, const Complex* r, double logTerm, const Complex& z1, double* w, double* dwdx, double* dwdy) {
+		Complex S[kMaxDegree + 1], T[kMaxDegree + 1];
+		for (int k = 0; k <= d; k++) {
+			S[k] = 0.00;
+			T[k] = 0.00;
+		}
+		bool withGrad = dwdx != nullptr && dwdy != nullptr;
+		for (int i = 0; i < e; i++) {
+			Complex I[kMaxDegree + 1];
+			logMoments(r[i], d, I);
+			Complex dz = 0.00;
+			for (int p = e; p >= 1; p--) {
+				dz = dz * r[i] + double(p) * z[p];
+			}
+			for (int k = 0; k <= d; k++) {
+				S[k] += I[k];
+				if (withGrad && k < d) {
+					T[k + 1] += double(k + 1) * I[k] / dz;
+				}
+			}
+		}
+		for (int k = 0; k <= d; k++) {
+			w[k] = S[k].imag() / (2 * M_PI);
+		}
+		for (int k = 1; k <= d; k++) {
+			w[d + k] = S[k].real() / (2 * M_PI) - logTerm;
+		}
+		if (!withGrad) {
+			return;
+		}
+		Complex dLog = z1 / (2 * M_PI * std::norm(z1));
+		for (int k = 0; k <= d; k++) {
+			Complex D = T[k] - 1.0 / z1;
+			if (k == 0) {
+				D += 1.0 / z[0];
+			}
+			dwdx[k] = D.imag() / (2 * M_PI);
+			dwdy[k] = D.real() / (2 * M_PI);
+			if (k > 0) {
+				dwdx[d + k] = D.real() / (2 * M_PI) + dLog.real();
+				dwdy[d + k] = -D.imag() / (2 * M_PI) + dLog.imag();
+			}
+		}
+	}
+
+	void segmentWeights(const std::vector<Point>& c, const Point& eta, double* w, double* dwdx, double* dwdy) {
+		int d = int(c.size()) - 1;
+		assert(d >= 1 && d <= kMaxDegree);
+		bool withGrad = dwdx != nullptr && dwdy != nullptr;
+
+		// z(t) = c(t) - eta, e is its actual degree (degree elevated cages have zero tails)
+		Complex z[kMaxDegree + 1];
+		for (int p = 0; p <= d; p++) {
+			z[p] = toComplex(c[p]);
+		}
+		z[0] -= toComplex(eta);
+		int e = d;
+		while (e > 1 && z[e] == 0.0) {
+			e--;
+		}
+		Complex r[kMaxDegree];
+		polyRoots(z, e, r);
+		Complex z1 = 0.00;
+		for (int p = 0; p <= d; p++) {
+			z1 += z[p];
+		}
+		double logTerm = ComplexMath::KernelMath::log(std::norm(z1)) / (4 * M_PI);
+		for (int i = 0; i < e; i++) {
+			if (std::abs(r[i].imag()) < kNearField && r[i].real() > -kNearField && r[i].real() < 1 + kNearField) {
+				nearFieldWeights(z, d, e, r, logTerm, z1, w, dwdx, dwdy);
+				return;
+			}
+		}
+
+		// F_m by partial fractions of 1/|z|^2 (simple poles r_i and conj(r_i)), and
+		// G_m = 1/(2pi) int t^m / (z^2 conj(z)) dt (double poles r_i, simple poles conj(r_i)),
+		// so that dF_m/dx = 2 Re G_m and dF_m/dy = -2 Im G_m. Both use
+		// I1(r, m) = int t^m / (t - r) dt = r I1(r, m - 1) + 1/m and I2(r, m) = d/dr I1(r, m).
+		int M = 3 * d - 1;
+		double F[kMaxMoment];
+		Complex G[kMaxMoment];
+		for (int m = 0; m <= M; m++) {
+			F[m] = 0.00;
+			G[m] = 0.00;
+		}
+		for (int i = 0; i < e; i++) {
+			Complex ri = r[i];
+			Complex ci = std::conj(ri);
+			Complex A = 1.0 / (ri - ci);
+			for (int l = 0; l < e; l++) {
+				if (l != i) {
+					A /= (ri - r[l]) * (ri - std::conj(r[l]));
+				}
+			}
+			Complex B, C, D;
+			if (withGrad) {
+				B = 1.0 / (ri - ci);
+				Complex logDeriv = 1.0 / (ri - ci);
+				D = 1.0 / ((ci - ri) * (ci - ri));
+				for (int l = 0; l < e; l++) {
+					if (l != i) {
+						B /= (ri - r[l]) * (ri - r[l]) * (ri - std::conj(r[l]));
+						logDeriv += 2.0 / (ri - r[l]) + 1.0 / (ri - std::conj(r[l]));
+						D /= (ci - r[l]) * (ci - r[l]) * (ci - std::conj(r[l]));
+					}
+				}
+				C = -B * logDeriv;
+			}
+			Complex I1 = ComplexMath::KernelMath::log(1.0 - ComplexMath::KernelMath::reciprocal(ri));
+			Complex I2 = 1.0 / (ri * (ri - 1.0));
+			for (int m = 0; m <= M; m++) {
+				if (m > 0) {
+					I2 = I1 + ri * I2;
+					I1 = ri * I1 + 1.0 / m;
+				}
+				F[m] += 2 * (A * I1).real();
+				if (withGrad) {
+					G[m] += B * I2 + C * I1 + D * std::conj(I1);
+				}
+			}
+		}
+		double scaleF = 1.00 / (2 * M_PI * std::norm(z[e]));
+		Complex scaleG = 1.00 / (2 * M_PI * z[e] * z[e] * std::conj(z[e]));
+		double Fx[kMaxMoment], Fy[kMaxMoment];
+		for (int m = 0; m <= M; m++) {
+			F[m] *= scaleF;
+			G[m] *= scaleG;
+			Fx[m] = 2 * G[m].real();
+			Fy[m] = -2 * G[m].imag();
+		}
+
+		// phi_k = sum_s a_s F_{s+k}, psi_k = sum_s b_s F_{s+k} - log|z(1)|/(2pi) with
+		// a_s = sum_{p+q=s+1} q cross(z_p, z_q) and b_s = sum_{p+q=s+1} q inner(z_p, z_q);
+		// only the p = 0 terms depend on eta
+		double a[2 * kMaxDegree], b[2 * kMaxDegree];
+		for (int s = 0; s < 2 * d; s++) {
+			a[s] = 0.00;
+			b[s] = 0.00;
+			for (int q = 1; q <= d; q++) {
+				int p = s + 1 - q;
+				if (p < 0 || p > d) {
+					continue;
+				}
+				a[s] += q * cross(z[p], z[q]);
+				b[s] += q * inner(z[p], z[q]);
+			}
+		}
+		for (int k = 0; k <= d; k++) {
+			double phi = 0.00;
+			for (int s = 0; s < 2 * d; s++) {
+				phi += a[s] * F[s + k];
+			}
+			w[k] = phi;
+		}
+		for (int k = 1; k <= d; k++) {
+			double psi = -logTerm;
+			for (int s = 0; s < 2 * d; s++) {
+				psi += b[s] * F[s + k];
+			}
+			w[d + k] = psi;
+		}
+		if (!withGrad) {
+			return;
+		}
+		Complex dLog = z1 / (2 * M_PI * std::norm(z1));
+		for (int k = 0; k <= d; k++) {
+			double phiX = 0.00, phiY = 0.00;
+			for (int s = 0; s < 2 * d; s++) {
+				phiX += a[s] * Fx[s + k];
+				phiY += a[s] * Fy[s + k];
+				if (s + 1 <= d) {
+					phiX -= (s + 1) * z[s + 1].imag() * F[s + k];
+					phiY += (s + 1) * z[s + 1].real() * F[s + k];
+				}
+			}
+			dwdx[k] = phiX;
+			dwdy[k] = phiY;
+		}
+		for (int k = 1; k <= d; k++) {
+			double psiX = dLog.real(), psiY = dLog.imag();
+			for (int s = 0; s < 2 * d; s++) {
+				psiX += b[s] * Fx[s + k];
+				psiY += b[s] * Fy[s + k];
+				if (s + 1 <= d) {
+					psiX -= (s + 1) * z[s + 1].real() * F[s + k];
+					psiY -= (s + 1) * z[s + 1].imag() * F[s + k];
+				}
+			}
+			dwdx[d + k] = psiX;
+			dwdy[d + k] = psiY;
+		}
+	}
+
+	void cageWeights(const std::vector<std::vector<Point>>& polyCage, const Point* pts, int nPts, double* W, int ldw, double* Wx, double* Wy) {
+		bool withGrad = Wx != nullptr && Wy != nullptr;
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int k = 0; k < nPts; k++) {
+			std::size_t offset = std::size_t(k) * ldw;
+			for (const auto& seg : polyCage) {
+				segmentWeights(seg, pts[k], W + offset, withGrad ? Wx + offset : nullptr, withGrad ? Wy + offset : nullptr);
+				offset += 2 * seg.size() - 1;
+			}
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
+#include <Eigen/Dense>
+
+
+namespace GreenCoords {
+	typedef OpenMesh::Vec3d Point;
+
+	// Green coordinates of one polynomial segment c(t) = sum_p c[p] t^p, t in [0, 1], at eta.
+	// With d = c.size() - 1, w receives 2d+1 values: phi_0..phi_d (weights of c[0..d]) followed
+	// by psi_1..psi_d (weights of arthono(c[1..d])), the layout used by calculate_green_weight.
+	// All moments F_m = 1/(2pi) int t^m / |c(t) - eta|^2 dt come from one root solve of c(t) - eta.
+	// dwdx/dwdy, when non-null, receive the derivatives of the same 2d+1 values with respect to
+	// eta, obtained by partial fractions over the same roots. When a root lies within kNearField
+	// of [0, 1], i.e. eta is close to the segment, both come from the logarithmic derivative
+	// z'/z = sum_i 1/(t - r_i) instead, which stays accurate down to the curve itself.
+	void segmentWeights(const std::vector<Point>& c, const Point& eta, double* w, double* dwdx = nullptr, double* dwdy = nullptr);
+
+	// Weights of a whole cage in power basis for nPts points. Row k of W (stride ldw) receives
+	// the segmentWeights of every segment one after another, Wx/Wy (same stride) the derivative
+	// weights when non-null. Points are distributed over threads.
+	void cageWeights(const std::vector<std::vector<Point>>& polyCage, const Point* pts, int nPts, double* W, int ldw, double* Wx = nullptr, double* Wy = nullptr);
+}
@@ -1,4 +1,5 @@
 #include "MVC.h"
+#include "ComplexMath.h"
 namespace MVC {
 	static std::vector<Point2D> y;
 	static std::vector<Point2D> z;
@@ -52,24 +53,10 @@ namespace MVC {
 		return Point2D(a.x * b.x + a.y * b.y, -a.x * b.y + a.y * b.x) / inner(b, b);
 	}
 	Point2D log(const Point2D& a) {
-		double R = std::log(inner(a, a)) / 2;
-		double I = 0.00;
-		if (a.x == 0 && a.y > 0) {
-			I = M_PI / 2;
-		}
-		else if (a.x == 0 && a.y < 0) {
-			I = 3 * M_PI / 2;
-		}
-		else if (a.x > 0.00 && a.y >= 0) {
-			I = std::atan(a.y / a.x);
-		}
-		else if (a.x > 0.00 && a.y < 0) {
-			I = std::atan(a.y / a.x) + 2 * M_PI;
-		}
-		else if (a.x < 0.00) {
-			I = std::atan(a.y / a.x) + M_PI;
-		}
-		return Point2D(R, I);
+		double R = ComplexMath::KernelMath::log(inner(a, a)) / 2;
+		// imaginary part in [0, 2*pi), log(0) keeps I = 0
+		double I = ComplexMath::KernelMath::atan2(a.y, a.x);
+		return Point2D(R, I < 0 ? I + 2 * M_PI : I);
 	}
 	Point2D atan(const Point2D& a) {
 		return rotateR(log((1 + rotateL(a)) / (1 - rotateL(a)))) / 2;
@@ -313,6 +300,421 @@ namespace MVC {
 		}
 	}
 
+	// SoA block of kBlock complex numbers, one lane per query point
+	typedef Eigen::Array<double, kBlock, 1> RealBlock;
+	typedef Eigen::Array<bool, kBlock, 1> MaskBlock;
+	struct PointBlock {
+		PointBlock() {}
+		PointBlock(const RealBlock& x_, const RealBlock& y_) : x(x_), y(y_) {}
+		RealBlock x;
+		RealBlock y;
+	};
+	typedef std::vector<RealBlock, Eigen::aligned_allocator<RealBlock>> RealBlocks;
+	typedef std::vector<PointBlock, Eigen::aligned_allocator<PointBlock>> PointBlocks;
+
+	inline PointBlock operator + (const PointBlock& a, const PointBlock& b) {
+		return PointBlock(a.x + b.x, a.y + b.y);
+	}
+	inline PointBlock operator + (const PointBlock& a, const RealBlock& t) {
+		return PointBlock(a.x + t, a.y);
+	}
+	inline PointBlock operator - (const PointBlock& a, const PointBlock& b) {
+		return PointBlock(a.x - b.x, a.y - b.y);
+	}
+	inline PointBlock operator * (const PointBlock& a, const PointBlock& b) {
+		return PointBlock(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+	}
+	inline PointBlock operator * (const PointBlock& a, const RealBlock& t) {
+		return PointBlock(a.x * t, a.y * t);
+	}
+	inline PointBlock operator * (const RealBlock& t, const PointBlock& a) {
+		return PointBlock(a.x * t, a.y * t);
+	}
+	inline PointBlock operator * (const PointBlock& a, double t) {
+		return PointBlock(a.x * t, a.y * t);
+	}
+	inline PointBlock operator * (double t, const PointBlock& a) {
+		return PointBlock(a.x * t, a.y * t);
+	}
+	inline PointBlock operator / (const PointBlock& a, const RealBlock& t) {
+		return PointBlock(a.x / t, a.y / t);
+	}
+	inline PointBlock operator / (const PointBlock& a, double t) {
+		return PointBlock(a.x / t, a.y / t);
+	}
+	inline PointBlock operator / (const PointBlock& a, const PointBlock& b) {
+		RealBlock invNorm = (b.x * b.x + b.y * b.y).inverse();
+		return PointBlock((a.x * b.x + a.y * b.y) * invNorm, (a.y * b.x - a.x * b.y) * invNorm);
+	}
+	inline PointBlock conj(const PointBlock& a) {
+		return PointBlock(a.x, -a.y);
+	}
+	inline PointBlock rotateR(const PointBlock& a) {
+		return PointBlock(a.y, -a.x);
+	}
+	inline RealBlock modulus(const PointBlock& a) {
+		return (a.x * a.x + a.y * a.y).sqrt();
+	}
+	// same branch as log(Point2D): imaginary part in [0, 2*pi)
+	PointBlock log(const PointBlock& a) {
+		PointBlock r;
+		RealBlock n2 = a.x * a.x + a.y * a.y;
+		for (int l = 0; l < kBlock; l++) {
+			r.x[l] = ComplexMath::KernelMath::log(n2[l]) / 2;
+			double I = ComplexMath::KernelMath::atan2(a.y[l], a.x[l]);
+			r.y[l] = I + (I < 0) * 2 * M_PI;
+		}
+		return r;
+	}
+	PointBlock atan(const PointBlock& a) {
+		PointBlock num(1 - a.y, a.x);
+		PointBlock den(1 + a.y, -a.x);
+		return rotateR(log(num / den)) / 2;
+	}
+
+	// edge data that does not depend on the query point
+	struct EdgeData {
+		int i;
+		int j;
+		Point2D vec;
+		double dist;
+		double invDist;
+		double distSquare;
+	};
+
+	static void cubicMVCsBatch(const std::vector<Point2D>& poly, const double* pts, int stride, int nPts, double* W, int ldw) {
+		if (nPts <= 0) {
+			return;
+		}
+		int n = int(poly.size());
+		std::vector<EdgeData> edges(n);
+		for (int i = 0; i < n; i++) {
+			EdgeData& e = edges[i];
+			e.i = i;
+			e.j = (i + 1) % n;
+			e.distSquare = distSquare(poly[e.i], poly[e.j]);
+			e.dist = sqrt(e.distSquare);
+			e.invDist = 1.00 / e.dist;
+			e.vec = (poly[e.j] - poly[e.i]) * e.invDist;
+		}
+		PointBlocks yB(n), zB(n);
+		RealBlocks vB(3 * n), gnB(6 * n), gtB(6 * n);
+		std::vector<double> vc(n), gnc(2 * n), gtc(2 * n);
+
+		for (int start = 0; start < nPts; start += kBlock) {
+			int count = std::min(kBlock, nPts - start);
+			// pad the last block with copies of its last point
+			RealBlock px, py;
+			for (int l = 0; l < kBlock; l++) {
+				const double* q = pts + std::size_t(start + std::min(l, count - 1)) * stride;
+				px[l] = q[0];
+				py[l] = q[1];
+			}
+			for (int i = 0; i < n; i++) {
+				yB[i] = PointBlock(poly[i].x - px, poly[i].y - py);
+				zB[i] = yB[i] / modulus(yB[i]);
+			}
+			for (auto& c : vB) c.setZero();
+			for (auto& c : gnB) c.setZero();
+			for (auto& c : gtB) c.setZero();
+			RealBlock A[3], B[3], C[3];
+			for (int k = 0; k < 3; k++) {
+				A[k].setZero();
+				B[k].setZero();
+				C[k].setZero();
+			}
+			MaskBlock fallback = MaskBlock::Constant(false);
+
+			for (const EdgeData& e : edges) {
+				int i = e.i, j = e.j;
+				RealBlock* vC[3] = { &vB[i], &vB[n + i], &vB[2 * n + i] };
+				RealBlock* vCj[3] = { &vB[j], &vB[n + j], &vB[2 * n + j] };
+				RealBlock* gnI[3] = { &gnB[2 * i], &gnB[2 * n + 2 * i], &gnB[4 * n + 2 * i] };
+				RealBlock* gtI[3] = { &gtB[2 * i], &gtB[2 * n + 2 * i], &gtB[4 * n + 2 * i] };
+				const PointBlock& yi = yB[i];
+				const PointBlock& yj = yB[j];
+				const PointBlock& zi = zB[i];
+				const PointBlock& zj = zB[j];
+				const Point2D& vecIJ = e.vec;
+				double distIJ = e.dist;
+				double invDistIJ = e.invDist;
+
+				RealBlock areaIJ = yj.y * yi.x - yj.x * yi.y;
+				// lanes on (or collinear with) this edge are redone by the scalar path
+				fallback = fallback || (areaIJ.abs() < 1E-10 * e.distSquare);
+
+				PointBlock alphaI = yj / areaIJ;
+				PointBlock kappaI[2] = { PointBlock(alphaI.y / 2, alphaI.x / 2), PointBlock(alphaI.y / 2, -alphaI.x / 2) };
+				PointBlock alphaJ = yi / RealBlock(-areaIJ);
+				PointBlock kappaJ[2] = { PointBlock(alphaJ.y / 2, alphaJ.x / 2), PointBlock(alphaJ.y / 2, -alphaJ.x / 2) };
+				PointBlock kappa[2] = { kappaI[0] + kappaJ[0], kappaI[1] + kappaJ[1] };
+
+				PointBlock intgIJ2 = (zj * zj * zj - zi * zi * zi) / 3;
+				PointBlock intgIJ1 = zj - zi;
+				PointBlock intgIJ0 = conj(zi) - conj(zj);
+
+				PointBlock kappaSquare = kappa[0] * kappa[0];
+				PointBlock kappaIntgIJ1 = kappa[0] * intgIJ1;
+				PointBlock kappaConjIntgIJ0 = kappa[1] * intgIJ0;
+				PointBlock kappaIJ = kappaI[0] * kappaJ[0];
+				PointBlock kappaI2 = kappaI[0] * kappaI[0];
+				PointBlock kappaI3 = kappaI[0] * kappaI2;
+				PointBlock kappaIIntgIJ2 = kappaI[0] * intgIJ2;
+				RealBlock kappaIAbsSquare = (kappaI[0] * kappaI[1]).x;
+				PointBlock kappaJ2 = kappaJ[0] * kappaJ[0];
+				PointBlock kappaJ3 = kappaJ[0] * kappaJ2;
+				PointBlock kappaJIntgIJ2 = kappaJ[0] * intgIJ2;
+				RealBlock kappaJAbsSquare = (kappaJ[0] * kappaJ[1]).x;
+
+				// A[0], vCoeff[0]
+				PointBlock tmpI = kappa[1] * kappaI[0];
+				PointBlock tmpJ = kappa[1] * kappaJ[0];
+				RealBlock valueI = 2 * (kappaSquare * kappaIIntgIJ2 + (tmpI + RealBlock(2 * tmpI.x)) * kappaIntgIJ1).y;
+				RealBlock valueJ = 2 * (kappaSquare * kappaJIntgIJ2 + (tmpJ + RealBlock(2 * tmpJ.x)) * kappaIntgIJ1).y;
+				*vC[0] += 2 * valueI;
+				*vCj[0] += 2 * valueJ;
+				A[0] += 2 * (valueI + valueJ);
+
+				// A[1], A[2], B[0], C[0], vCoeff[1], vCoeff[2], gCoeff[0]
+				PointBlock intgI = rotateR(kappa[0] * kappaIIntgIJ2 + intgIJ1 * RealBlock(2 * tmpI.x) + kappaI[1] * kappaConjIntgIJ0);
+				PointBlock intgJ = rotateR(kappa[0] * kappaJIntgIJ2 + intgIJ1 * RealBlock(2 * tmpJ.x) + kappaJ[1] * kappaConjIntgIJ0);
+				*vC[1] += 3 * intgI.x;
+				*vCj[1] += 3 * intgJ.x;
+				*vC[2] += 3 * intgI.y;
+				*vCj[2] += 3 * intgJ.y;
+				B[0] += (intgI.x + intgJ.x);
+				C[0] += (intgI.y + intgJ.y);
+				A[1] += 3 * (intgI.x + intgJ.x);
+				A[2] += 3 * (intgI.y + intgJ.y);
+				RealBlock gIJ = -vecIJ.x * (intgI.x + intgJ.x) - vecIJ.y * (intgI.y + intgJ.y);
+				gnI[0][0] += (vecIJ.y * intgI.x - vecIJ.x * intgI.y);
+				gnI[0][1] += (vecIJ.y * intgJ.x - vecIJ.x * intgJ.y);
+				*vC[0] -= gIJ * invDistIJ;
+				*vCj[0] += gIJ * invDistIJ;
+
+				// B[1], B[2], C[1], C[2], gCoeff[1], gCoeff[2]
+				intgI = rotateR(kappaIIntgIJ2 + kappaI[1] * intgIJ1);
+				intgJ = rotateR(kappaJIntgIJ2 + kappaJ[1] * intgIJ1);
+				valueI = 2 * (kappaI[0] * intgIJ1).y;
+				valueJ = 2 * (kappaJ[0] * intgIJ1).y;
+				RealBlock coscosI = (valueI + intgI.x) / 2;
+				RealBlock sinsinI = (valueI - intgI.x) / 2;
+				RealBlock sincosI = intgI.y / 2;
+				RealBlock coscosJ = (valueJ + intgJ.x) / 2;
+				RealBlock sinsinJ = (valueJ - intgJ.x) / 2;
+				RealBlock sincosJ = intgJ.y / 2;
+				B[1] += 2 * (coscosI + coscosJ);
+				B[2] += 2 * (sincosI + sincosJ);
+				C[1] += 2 * (sincosI + sincosJ);
+				C[2] += 2 * (sinsinI + sinsinJ);
+				gIJ = -vecIJ.x * (coscosI + coscosJ) - vecIJ.y * (sincosI + sincosJ);
+				gnI[1][0] += (vecIJ.y * coscosI - vecIJ.x * sincosI);
+				gnI[1][1] += (vecIJ.y * coscosJ - vecIJ.x * sincosJ);
+				*vC[1] -= gIJ * invDistIJ;
+				*vCj[1] += gIJ * invDistIJ;
+				gIJ = -vecIJ.x * (sincosI + sincosJ) - vecIJ.y * (sinsinI + sinsinJ);
+				gnI[2][0] += (vecIJ.y * sincosI - vecIJ.x * sinsinI);
+				gnI[2][1] += (vecIJ.y * sincosJ - vecIJ.x * sinsinJ);
+				*vC[2] -= gIJ * invDistIJ;
+				*vCj[2] += gIJ * invDistIJ;
+
+				// cubic components for vCoeff[*] and gtCoeff[*]
+				tmpI = kappaI[1] * kappaJ[0];
+				tmpJ = kappaJ[1] * kappaI[0];
+				valueI = 2 * distIJ * (kappaI2 * kappaJIntgIJ2 + (tmpI + RealBlock(2 * tmpI.x)) * kappaI[0] * intgIJ1).y;
+				valueJ = 2 * distIJ * (kappaJ2 * kappaIIntgIJ2 + (tmpJ + RealBlock(2 * tmpJ.x)) * kappaJ[0] * intgIJ1).y;
+				gtI[0][0] += 2 * valueI;
+				gtI[0][1] += 2 * valueJ;
+
+				PointBlock tmpIntgII = (kappaI2 * intgIJ2 + intgIJ1 * RealBlock(2 * kappaIAbsSquare) + conj(kappaI2) * intgIJ0);
+				PointBlock tmpIntgJJ = (kappaJ2 * intgIJ2 + intgIJ1 * RealBlock(2 * kappaJAbsSquare) + conj(kappaJ2) * intgIJ0);
+				PointBlock tmpIntgIJ = (kappaIJ * intgIJ2 + intgIJ1 * RealBlock(tmpI.x + tmpJ.x) + conj(kappaIJ) * intgIJ0);
+				intgI = rotateR(tmpIntgII - 2 * tmpIntgIJ);
+				intgJ = rotateR(tmpIntgJJ - 2 * tmpIntgIJ);
+				gtI[0][0] -= (vecIJ.x * intgI.x + vecIJ.y * intgI.y);
+				gtI[0][1] += (vecIJ.x * intgJ.x + vecIJ.y * intgJ.y);
+
+				RealBlock invKappaAbs = modulus(kappa[0]).inverse();
+				PointBlock invKappa = kappa[1] * RealBlock(invKappaAbs * invKappaAbs);
+				PointBlock kappaR = kappa[1] * invKappa;
+				PointBlock intgZ1 = (atan(zj * kappa[0] * invKappaAbs) - atan(zi * kappa[0] * invKappaAbs)) * invKappaAbs;
+				PointBlock intgZ0 = intgIJ1 * invKappa - intgZ1 * kappaR;
+
+				PointBlock sI = kappaI3 * invKappa;
+				PointBlock tI = kappaI2 * (3 * kappaI[1] - kappaI[0] * kappaR);
+				PointBlock sJ = kappaJ3 * invKappa;
+				PointBlock tJ = kappaJ2 * (3 * kappaJ[1] - kappaJ[0] * kappaR);
+				intgI = distIJ * rotateR(tmpIntgII - (sI * intgIJ2 + conj(sI) * intgIJ0 + tI * intgZ0 + conj(tI) * intgZ1));
+				intgJ = distIJ * rotateR(tmpIntgJJ - (sJ * intgIJ2 + conj(sJ) * intgIJ0 + tJ * intgZ0 + conj(tJ) * intgZ1));
+				gtI[1][0] += 3 * intgI.x;
+				gtI[1][1] += 3 * intgJ.x;
+				gtI[2][0] += 3 * intgI.y;
+				gtI[2][1] += 3 * intgJ.y;
+
+				sI = 3 * kappaI2 * invKappa - 2 * kappaI[0];
+				RealBlock uI = 6 * kappaIAbsSquare - 6 * (kappaI2 * kappaR).x;
+				sJ = 3 * kappaJ2 * invKappa - 2 * kappaJ[0];
+				RealBlock uJ = 6 * kappaJAbsSquare - 6 * (kappaJ2 * kappaR).x;
+				intgI = rotateR(sI * intgIJ2 + conj(sI) * intgIJ1 + uI * intgZ0);
+				intgJ = rotateR(sJ * intgIJ2 + conj(sJ) * intgIJ1 + uJ * intgZ0);
+				valueI = 2 * (sI * intgIJ1).y + 2 * uI * intgZ1.y;
+				valueJ = 2 * (sJ * intgIJ1).y + 2 * uJ * intgZ1.y;
+				coscosI = (valueI + intgI.x) / 2;
+				sinsinI = (valueI - intgI.x) / 2;
+				sincosI = intgI.y / 2;
+				coscosJ = (valueJ + intgJ.x) / 2;
+				sinsinJ = (valueJ - intgJ.x) / 2;
+				sincosJ = intgJ.y / 2;
+				gtI[1][0] -= (vecIJ.x * coscosI + vecIJ.y * sincosI);
+				gtI[1][1] += (vecIJ.x * coscosJ + vecIJ.y * sincosJ);
+				gtI[2][0] -= (vecIJ.x * sincosI + vecIJ.y * sinsinI);
+				gtI[2][1] += (vecIJ.x * sincosJ + vecIJ.y * sinsinJ);
+
+				for (int k = 0; k < 3; k++) {
+					*vC[k] += (gtI[k][0] - gtI[k][1]) * invDistIJ;
+					*vCj[k] -= (gtI[k][0] - gtI[k][1]) * invDistIJ;
+				}
+			}
+			RealBlock lambda[3] = { B[1] * C[2] - B[2] * C[1], B[2] * C[0] - B[0] * C[2], B[0] * C[1] - B[1] * C[0] };
+			RealBlock sum = A[0] * lambda[0] + A[1] * lambda[1] + A[2] * lambda[2];
+			RealBlock scale = (sum != 0.00).select(sum.inverse(), RealBlock::Ones());
+			for (int k = 0; k < 3; k++) {
+				lambda[k] *= scale;
+			}
+
+			for (int i = 0; i < n; i++) {
+				RealBlock v = lambda[0] * vB[i] + lambda[1] * vB[n + i] + lambda[2] * vB[2 * n + i];
+				RealBlock gt0 = lambda[0] * gtB[2 * i] + lambda[1] * gtB[2 * n + 2 * i] + lambda[2] * gtB[4 * n + 2 * i];
+				RealBlock gt1 = lambda[0] * gtB[2 * i + 1] + lambda[1] * gtB[2 * n + 2 * i + 1] + lambda[2] * gtB[4 * n + 2 * i + 1];
+				RealBlock gn0 = lambda[0] * gnB[2 * i] + lambda[1] * gnB[2 * n + 2 * i] + lambda[2] * gnB[4 * n + 2 * i];
+				RealBlock gn1 = lambda[0] * gnB[2 * i + 1] + lambda[1] * gnB[2 * n + 2 * i + 1] + lambda[2] * gnB[4 * n + 2 * i + 1];
+				for (int l = 0; l < count; l++) {
+					double* row = W + std::size_t(start + l) * ldw + 5 * i;
+					row[0] = v[l];
+					row[1] = gt0[l];
+					row[2] = gt1[l];
+					row[3] = gn0[l];
+					row[4] = gn1[l];
+				}
+			}
+			for (int l = 0; l < count; l++) {
+				if (!fallback[l]) {
+					continue;
+				}
+				cubicMVCs(poly, Point2D(px[l], py[l]), vc, gnc, gtc);
+				double* row = W + std::size_t(start + l) * ldw;
+				for (int i = 0; i < n; i++) {
+					row[5 * i + 0] = vc[i];
+					row[5 * i + 1] = gtc[2 * i];
+					row[5 * i + 2] = gtc[2 * i + 1];
+					row[5 * i + 3] = gnc[2 * i];
+					row[5 * i + 4] = gnc[2 * i + 1];
+				}
+			}
+		}
+	}
+
+	void cubicMVCs(const std::vector<Point2D>& poly, const Point2D* pts, int nPts, double* W, int ldw) {
+		cubicMVCsBatch(poly, &pts->x, 2, nPts, W, ldw);
+	}
+
+	static void meanValueCoordsBatch(const std::vector<Point2D>& poly, const double* pts, int stride, int nPts, double* W, int ldw) {
+		int n = int(poly.size());
+		if (nPts <= 0 || n < 3) {
+			return;
+		}
+		// tolerance of the half-angle denominator, relative to the squared edge length
+		std::vector<double> eps(n);
+		for (int i = 0; i < n; i++) {
+			eps[i] = 1E-12 * distSquare(poly[i], poly[(i + 1) % n]);
+		}
+		int nBlocks = (nPts + kBlock - 1) / kBlock;
+
+#pragma omp parallel
+		{
+			PointBlocks d(n);
+			RealBlocks r(n), t(n), den(n);
+#pragma omp for schedule(static)
+			for (int b = 0; b < nBlocks; b++) {
+				int start = b * kBlock;
+				int count = std::min(kBlock, nPts - start);
+				RealBlock px, py;
+				for (int l = 0; l < kBlock; l++) {
+					const double* q = pts + std::size_t(start + std::min(l, count - 1)) * stride;
+					px[l] = q[0];
+					py[l] = q[1];
+				}
+				for (int i = 0; i < n; i++) {
+					d[i] = PointBlock(poly[i].x - px, poly[i].y - py);
+					r[i] = modulus(d[i]);
+				}
+				// den vanishes when alpha_i = pi (p on edge i) or when p sits on one of its ends
+				MaskBlock onBoundary = MaskBlock::Constant(false);
+				for (int i = 0; i < n; i++) {
+					int j = (i + 1) % n;
+					den[i] = r[i] * r[j] + d[i].x * d[j].x + d[i].y * d[j].y;
+					onBoundary = onBoundary || (den[i] <= eps[i]);
+					t[i] = (d[i].x * d[j].y - d[i].y * d[j].x) / den[i];
+				}
+				RealBlock sum = RealBlock::Zero();
+				for (int i = 0; i < n; i++) {
+					// reuse r[i] for the unnormalized weight of vertex i
+					r[i] = (t[(i + n - 1) % n] + t[i]) / r[i];
+					sum += r[i];
+				}
+				RealBlock invSum = sum.inverse();
+				for (int l = 0; l < count; l++) {
+					double* row = W + std::size_t(start + l) * ldw;
+					if (!onBoundary[l]) {
+						for (int i = 0; i < n; i++) {
+							row[i] = r[i][l] * invSum[l];
+						}
+						continue;
+					}
+					int e = 0;
+					for (int i = 1; i < n; i++) {
+						if (den[i][l] < den[e][l]) {
+							e = i;
+						}
+					}
+					int f = (e + 1) % n;
+					double de = modulus(Point2D(d[e].x[l], d[e].y[l]));
+					double df = modulus(Point2D(d[f].x[l], d[f].y[l]));
+					for (int i = 0; i < n; i++) {
+						row[i] = 0.00;
+					}
+					if (de + df > 0) {
+						row[e] = df / (de + df);
+						row[f] = de / (de + df);
+					}
+					else {
+						row[e] = 1.00;
+					}
+				}
+			}
+		}
+	}
+
+	void meanValueCoords(const std::vector<Point2D>& poly, const Point2D* pts, int nPts, double* W, int ldw) {
+		meanValueCoordsBatch(poly, &pts->x, 2, nPts, W, ldw);
+	}
+
+	void meanValueCoords(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d* pts, int nPts, double* W, int ldw) {
+		std::vector<Point2D> poly2D;
+		for (const auto& vertex : poly) {
+			poly2D.emplace_back(vertex[0], vertex[1]);
+		}
+		meanValueCoordsBatch(poly2D, pts->data(), 3, nPts, W, ldw);
+	}
+
+	void cubicMVCs(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d* pts, int nPts, double* W, int ldw) {
+		std::vector<Point2D> poly2D;
+		for (const auto& vertex : poly) {
+			poly2D.emplace_back(vertex[0], vertex[1]);
+		}
+		cubicMVCsBatch(poly2D, pts->data(), 3, nPts, W, ldw);
+	}
+
 	void cubicMVCs(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d& p, std::vector<double>& vCoords, std::vector<double>& gnCoords, std::vector<double>& gtCoords) {
 		// Convert OpenMesh::Vec3d to Point2D
 		std::vector<Point2D> poly2D;
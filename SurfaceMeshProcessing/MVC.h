@@ -30,4 +30,20 @@ namespace MVC {
 
 	void cubicMVCs(const std::vector<Point2D>& poly, const Point2D& p, std::vector<double>& vCoords, std::vector<double>& gnCoords, std::vector<double>& gtCoords);
 	void cubicMVCs(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d& p, std::vector<double>& vCoords, std::vector<double>& gnCoords, std::vector<double>& gtCoords);
+
+	// Batched evaluation for many query points against one polygon. The edge data is
+	// prepared once, the points are processed in blocks of kBlock lanes, and row k of W
+	// (stride ldw) receives 5 coordinates per edge i: [v_i, gt_2i, gt_2i+1, gn_2i, gn_2i+1].
+	// Points lying on (or collinear with) an edge fall back to the scalar path above.
+	const int kBlock = 8;
+	void cubicMVCs(const std::vector<Point2D>& poly, const Point2D* pts, int nPts, double* W, int ldw);
+	void cubicMVCs(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d* pts, int nPts, double* W, int ldw);
+
+	// Classic (linear) mean value coordinates for many query points. Each edge contributes
+	// tan(alpha/2) = cross(d_i, d_j) / (|d_i||d_j| + dot(d_i, d_j)) with d_i = poly[i] - p, so no
+	// acos/tan is evaluated. Row k of W (stride ldw) receives one weight per polygon vertex.
+	// Points on a vertex or an edge get the linear interpolation of that edge; blocks of
+	// kBlock points are distributed over threads.
+	void meanValueCoords(const std::vector<Point2D>& poly, const Point2D* pts, int nPts, double* W, int ldw);
+	void meanValueCoords(const std::vector<OpenMesh::Vec3d>& poly, const OpenMesh::Vec3d* pts, int nPts, double* W, int ldw);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <cctype>
+#include <algorithm>
 
 void MeshTools::CalcWeight(Mesh& mesh)
 {
@@ -188,8 +189,19 @@ void MeshTools::SolveUpdate(Mesh& mesh, Mesh& deformedMesh, std::map<int, int>&
 	}
 }
 
-bool MeshTools::ReadMesh(Mesh & mesh, const std::string & filename)
+bool MeshTools::ReadMesh(Mesh & mesh, const std::string & filename, std::vector<int>* vertexOrder)
 {
+	if (vertexOrder)
+	{
+		Mesh original;
+		if (!ReadMesh(original, filename))
+		{
+			return false;
+		}
+		ReorderVertices(original, mesh, *vertexOrder);
+		return true;
+	}
+
 	std::string path(".");
 	auto slash = filename.find_last_of('/');
 	auto backslash = filename.find_last_of('\\');
@@ -578,6 +590,106 @@ void MeshTools::Reassign(const Mesh & mesh1, Mesh & mesh2)
 	}
 }
 
+// Index of (x, y) along a Hilbert curve filling a 2^bits x 2^bits grid
+static unsigned long long HilbertIndex(unsigned x, unsigned y, int bits)
+{
+	unsigned n = 1u << bits;
+	unsigned long long d = 0;
+	for (unsigned s = n / 2; s > 0; s /= 2)
+	{
+		unsigned rx = (x & s) > 0;
+		unsigned ry = (y & s) > 0;
+		d += (unsigned long long)s * s * ((3 * rx) ^ ry);
+		// rotate the quadrant so that the curve inside it starts and ends at the right corners
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n - 1 - x;
+				y = n - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+// Copies mesh1 into mesh2 with the vertices sorted along a Hilbert curve over the two longest
+//   sides of the bounding box, so that vertices close in space are close in memory. Faces keep
+//   their order and orientation. order[i] is the index in mesh1 of vertex i of mesh2.
+void MeshTools::ReorderVertices(const Mesh & mesh1, Mesh & mesh2, std::vector<int> & order)
+{
+	int nv = (int)mesh1.n_vertices();
+	order.resize(nv);
+	for (int i = 0; i < nv; i++)
+	{
+		order[i] = i;
+	}
+	if (nv > 0)
+	{
+		Mesh::Point bmax, bmin;
+		BoundingBox(mesh1, bmax, bmin);
+		Mesh::Point size = bmax - bmin;
+		int a0 = 0, a1 = 1, a2 = 2;
+		if (size[a1] < size[a2]) std::swap(a1, a2);
+		if (size[a0] < size[a1]) std::swap(a0, a1);
+		if (size[a1] < size[a2]) std::swap(a1, a2);
+		const int bits = 16;
+		double scale = ((1 << bits) - 1) / std::max(size[a0], 1e-300);
+		std::vector<unsigned long long> key(nv);
+		for (int i = 0; i < nv; i++)
+		{
+			const auto & p = mesh1.point(mesh1.vertex_handle(i));
+			key[i] = HilbertIndex(unsigned((p[a0] - bmin[a0]) * scale), unsigned((p[a1] - bmin[a1]) * scale), bits);
+		}
+		std::stable_sort(order.begin(), order.end(), [&key](int i, int j) { return key[i] < key[j]; });
+	}
+	std::vector<int> position(nv);
+	for (int i = 0; i < nv; i++)
+	{
+		position[order[i]] = i;
+	}
+	mesh2.clear();
+	for (int i = 0; i < nv; i++)
+	{
+		mesh2.add_vertex(mesh1.point(mesh1.vertex_handle(order[i])));
+	}
+	for (const auto & fh : mesh1.faces())
+	{
+		std::vector<Mesh::VertexHandle> vhs;
+		for (const auto & fvh : mesh1.fv_range(fh))
+		{
+			vhs.push_back(mesh2.vertex_handle(position[fvh.idx()]));
+		}
+		mesh2.add_face(vhs);
+	}
+}
+
+// Inverse of ReorderVertices: mesh2 gets the vertices of mesh1 back in the original order
+void MeshTools::RestoreVertexOrder(const Mesh & mesh1, const std::vector<int> & order, Mesh & mesh2)
+{
+	mesh2.clear();
+	int nv = (int)mesh1.n_vertices();
+	std::vector<int> position(nv);
+	for (int i = 0; i < nv; i++)
+	{
+		position[order[i]] = i;
+	}
+	for (int i = 0; i < nv; i++)
+	{
+		mesh2.add_vertex(mesh1.point(mesh1.vertex_handle(position[i])));
+	}
+	for (const auto & fh : mesh1.faces())
+	{
+		std::vector<Mesh::VertexHandle> vhs;
+		for (const auto & fvh : mesh1.fv_range(fh))
+		{
+			vhs.push_back(mesh2.vertex_handle(order[fvh.idx()]));
+		}
+		mesh2.add_face(vhs);
+	}
+}
+
 void MeshTools::Deform(Mesh& mesh, Mesh& deformedMesh)
 {
 	CalcWeight(mesh);//Ȩ
@@ -30,6 +30,9 @@ enum VertexState {
 	Custom
 };
 
+// one row per mesh vertex, contiguous so that rows can be filled and read in place
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> WeightMatrix;
+
 class MeshTools
 {
 private:
@@ -48,7 +51,9 @@ private:
 	static void SolveUpdate(Mesh& mesh, Mesh& deformedMesh, std::map<int, int>& compressedIndex,
 		Eigen::SimplicialCholesky<SpMat>& chol, std::vector<Eigen::VectorXd>& bias);
 public:
-	static bool ReadMesh(Mesh & mesh, const std::string & filename);
+	// with vertexOrder, the vertices are reordered along a Hilbert curve (see ReorderVertices)
+	//   and (*vertexOrder)[i] receives the index in the file of vertex i
+	static bool ReadMesh(Mesh & mesh, const std::string & filename, std::vector<int>* vertexOrder = nullptr);
 	static bool ReadOBJ(Mesh & mesh, const std::string & filename);
 	//static bool ReadOFF(Mesh & mesh, const std::string & filename);
 	static bool WriteMesh(const Mesh & mesh, const std::string & filename, const std::streamsize & precision = 6);
@@ -60,6 +65,8 @@ public:
 	static int Genus(const Mesh & mesh);
 	static void BoundingBox(const Mesh & mesh, Mesh::Point & bmax, Mesh::Point & bmin);
 	static void Reassign(const Mesh & mesh1, Mesh & mesh2);
+	static void ReorderVertices(const Mesh & mesh1, Mesh & mesh2, std::vector<int> & order);
+	static void RestoreVertexOrder(const Mesh & mesh1, const std::vector<int> & order, Mesh & mesh2);
 	static void Deform(Mesh& mesh, Mesh& deformedMesh);
 	static void AssignPoints(Mesh& mesh, Mesh& deformedMesh);
 };
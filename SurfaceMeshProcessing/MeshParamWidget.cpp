@@ -25,6 +25,17 @@ void MeshParamWidget::CreateTabWidget(void)
 	changedegreeBtn = new QPushButton(tr("Changedegree"));
 	nodrawpointBtn = new QPushButton(tr("No drawpoint"));
 	addpointsBtn = new QPushButton(tr("Add points"));
+	mvcPreviewBtn = new QPushButton(tr("MVC Preview"));
+	distortionBtn = new QPushButton(tr("Distortion"));
+	addKeyframeBtn = new QPushButton(tr("Add Keyframe"));
+	renderAnimationBtn = new QPushButton(tr("Render Animation"));
+	recordSessionBtn = new QPushButton(tr("Record Drags"));
+	subCageBtn = new QPushButton(tr("Sub Cage"));
+	addLayerBtn = new QPushButton(tr("Add Layer"));
+	arapRefineBtn = new QPushButton(tr("ARAP Refine"));
+	undoBtn = new QPushButton(tr("Undo"));
+	redoBtn = new QPushButton(tr("Redo"));
+	distortionLabel = new QLabel();
 
 	
 	connect(SelectAdjustBtn, SIGNAL(clicked()), SIGNAL(SelectAdjustSignal()));
@@ -36,6 +47,16 @@ void MeshParamWidget::CreateTabWidget(void)
 	connect(changedegreeBtn, SIGNAL(clicked()), SIGNAL(ChangedegreeSignal()));
 	connect(nodrawpointBtn, SIGNAL(clicked()), SIGNAL(NodrawpointSignal()));
 	connect(addpointsBtn, SIGNAL(clicked()), SIGNAL(AddpointsSignal()));
+	connect(mvcPreviewBtn, SIGNAL(clicked()), SIGNAL(MVCPreviewSignal()));
+	connect(distortionBtn, SIGNAL(clicked()), SIGNAL(DistortionSignal()));
+	connect(addKeyframeBtn, SIGNAL(clicked()), SIGNAL(AddKeyframeSignal()));
+	connect(renderAnimationBtn, SIGNAL(clicked()), SIGNAL(RenderAnimationSignal()));
+	connect(recordSessionBtn, SIGNAL(clicked()), SIGNAL(RecordSessionSignal()));
+	connect(subCageBtn, SIGNAL(clicked()), SIGNAL(SubCageSignal()));
+	connect(addLayerBtn, SIGNAL(clicked()), SIGNAL(AddLayerSignal()));
+	connect(arapRefineBtn, SIGNAL(clicked()), SIGNAL(ArapRefineSignal()));
+	connect(undoBtn, SIGNAL(clicked()), SIGNAL(UndoSignal()));
+	connect(redoBtn, SIGNAL(clicked()), SIGNAL(RedoSignal()));
 
 	QVBoxLayout *layout = new QVBoxLayout();
 	layout->addWidget(pbPrintInfo);
@@ -48,6 +69,17 @@ void MeshParamWidget::CreateTabWidget(void)
 	layout->addWidget(changedegreeBtn);
 	layout->addWidget(nodrawpointBtn);
 	layout->addWidget(addpointsBtn);
+	layout->addWidget(mvcPreviewBtn);
+	layout->addWidget(distortionBtn);
+	layout->addWidget(addKeyframeBtn);
+	layout->addWidget(renderAnimationBtn);
+	layout->addWidget(recordSessionBtn);
+	layout->addWidget(subCageBtn);
+	layout->addWidget(addLayerBtn);
+	layout->addWidget(arapRefineBtn);
+	layout->addWidget(undoBtn);
+	layout->addWidget(redoBtn);
+	layout->addWidget(distortionLabel);
 	layout->addStretch();
 	wParam = new QWidget();
 	wParam->setLayout(layout);
@@ -69,6 +101,11 @@ void MeshParamWidget::CreateLayout(void)
 	this->setLayout(layout);
 }
 
+void MeshParamWidget::SetDistortionInfo(QString info)
+{
+	distortionLabel->setText(info);
+}
+
 
 void MeshParamWidget::ResetCheck()
 {
@@ -24,7 +24,19 @@ signals:
 	void ChangedegreeSignal();
 	void NodrawpointSignal();
 	void AddpointsSignal();
+	void MVCPreviewSignal();
+	void DistortionSignal();
+	void AddKeyframeSignal();
+	void RenderAnimationSignal();
+	void RecordSessionSignal();
+	void SubCageSignal();
+	void AddLayerSignal();
+	void ArapRefineSignal();
+	void UndoSignal();
+	void RedoSignal();
 	void ClearSignal();
+public slots:
+	void SetDistortionInfo(QString info);
 private slots:
 	void ResetCheck();
 private:
@@ -41,6 +53,17 @@ private:
 	QPushButton* changedegreeBtn;
 	QPushButton* nodrawpointBtn;
 	QPushButton* addpointsBtn;
+	QPushButton* mvcPreviewBtn;
+	QPushButton* distortionBtn;
+	QPushButton* addKeyframeBtn;
+	QPushButton* renderAnimationBtn;
+	QPushButton* recordSessionBtn;
+	QPushButton* subCageBtn;
+	QPushButton* addLayerBtn;
+	QPushButton* arapRefineBtn;
+	QPushButton* undoBtn;
+	QPushButton* redoBtn;
+	QLabel* distortionLabel;
 	QButtonGroup* deformBtnGroup;
 	QWidget* deformWidget;
 };
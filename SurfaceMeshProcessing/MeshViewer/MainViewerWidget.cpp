@@ -41,6 +41,17 @@ void MainViewerWidget::CreateParamWidget(void)
 	connect(meshparamwidget, SIGNAL(ChangedegreeSignal()), meshviewerwidget, SLOT(SetSMChangedegree()));
 	connect(meshparamwidget, SIGNAL(NodrawpointSignal()), meshviewerwidget, SLOT(SetSMNodrawpoint()));
 	connect(meshparamwidget, SIGNAL(AddpointsSignal()), meshviewerwidget, SLOT(SetSMAddpoints()));
+	connect(meshparamwidget, SIGNAL(MVCPreviewSignal()), meshviewerwidget, SLOT(SetSMMVCPreview()));
+	connect(meshparamwidget, SIGNAL(DistortionSignal()), meshviewerwidget, SLOT(SetSMDistortion()));
+	connect(meshparamwidget, SIGNAL(AddKeyframeSignal()), meshviewerwidget, SLOT(SetSMAddKeyframe()));
+	connect(meshparamwidget, SIGNAL(RenderAnimationSignal()), meshviewerwidget, SLOT(SetSMRenderAnimation()));
+	connect(meshparamwidget, SIGNAL(RecordSessionSignal()), meshviewerwidget, SLOT(SetSMRecordSession()));
+	connect(meshparamwidget, SIGNAL(SubCageSignal()), meshviewerwidget, SLOT(SetSMSubCage()));
+	connect(meshparamwidget, SIGNAL(AddLayerSignal()), meshviewerwidget, SLOT(SetSMAddLayer()));
+	connect(meshparamwidget, SIGNAL(ArapRefineSignal()), meshviewerwidget, SLOT(SetSMArapRefine()));
+	connect(meshparamwidget, SIGNAL(UndoSignal()), meshviewerwidget, SLOT(SetSMUndo()));
+	connect(meshparamwidget, SIGNAL(RedoSignal()), meshviewerwidget, SLOT(SetSMRedo()));
+	connect(meshviewerwidget, SIGNAL(DistortionInfoSignal(QString)), meshparamwidget, SLOT(SetDistortionInfo(QString)));
 }
 
 void MainViewerWidget::CreateViewerDialog(void)
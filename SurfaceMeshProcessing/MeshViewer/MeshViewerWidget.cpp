@@ -2,14 +2,14 @@
 #include <complex.h>
 #include <OpenMesh/Core/IO/MeshIO.hh>
 #include "MeshViewerWidget.h"
+#include "ComplexMath.h"
+#include "stb_image.h"
 #include <math.h>
 #include <cmath>
 #define _USE_MATH_DEFINES
 
 void DrawPoints3d(const vector<OpenMesh::Vec3d>& Points, float r = 0.0f, float g = 0.0f, float b = 1.0f, float pointsize = 5.0f);
-Mesh createMeshFromCurveCage(const std::vector<Mesh::Point>& curvecage2);
-std::vector<std::vector<Mesh::Point>> CCpoints_fromCCmesh(const Mesh CC_mesh,int degree);
-std::vector<double> mvc(const Mesh::Point p, const std::vector<Mesh::Point> vts);
+std::vector<double> mvc(const Mesh::Point& p, const std::vector<Mesh::Point>& vts);
 //֣tmη,ĸt1η
 double F1_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1,  int m);
 //֣tmη,ĸt2η
@@ -17,7 +17,6 @@ double F2_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, c
 void Cardano(complex<double> a, complex<double> b, complex<double> c, complex<double>d, complex<double>& x1, complex<double>& x2, complex<double>& x3);
 //֣tmηĸt3η
 double F3_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, const Mesh::Point c2, const Mesh::Point c3, int m);
-Mesh::Point evaluate_coor(const std::vector<double> weight, const std::vector<Mesh::Point> ctps);
 //lsbص
 MeshViewerWidget::MeshViewerWidget(QWidget* parent)
 	: QGLViewerWidget(parent),
@@ -37,7 +36,7 @@ MeshViewerWidget::~MeshViewerWidget(void)
 bool MeshViewerWidget::LoadMesh(const std::string & filename)
 {
 	Clear();
-	bool read_OK = MeshTools::ReadMesh(mesh, filename);
+	bool read_OK = MeshTools::ReadMesh(mesh, filename, &vertexOrder);
 	std::cout << "Load mesh from file " << filename << std::endl;
 	if (read_OK)
 	{
@@ -52,6 +51,8 @@ bool MeshViewerWidget::LoadMesh(const std::string & filename)
 		}
 		selectMode = NoSelect;
 		UpdateMesh();
+		metrics.SetRest(mesh);
+		set_arap_rest();
 		update();
 		return true;
 	}
@@ -60,7 +61,14 @@ bool MeshViewerWidget::LoadMesh(const std::string & filename)
 
 void MeshViewerWidget::Clear(void)
 {
+	deformWorker.Stop();
+	proxy.Clear();
+	clear_sub_cage();
+	clear_layers();
+	arap.Clear();
+	history.Clear();
 	mesh.clear();
+	vertexOrder.clear();
 }
 
 void MeshViewerWidget::UpdateMesh(void)
@@ -104,6 +112,13 @@ void MeshViewerWidget::UpdateMesh(void)
 
 bool MeshViewerWidget::SaveMesh(const std::string & filename)
 {
+	//ļеĶ˳򱣴
+	if (vertexOrder.size() == mesh.n_vertices())
+	{
+		Mesh original;
+		MeshTools::RestoreVertexOrder(mesh, vertexOrder, original);
+		return MeshTools::WriteMesh(original, filename, DBL_DECIMAL_DIG);
+	}
 	return MeshTools::WriteMesh(mesh, filename, DBL_DECIMAL_DIG);
 }
 
@@ -198,34 +213,26 @@ void MeshViewerWidget::SetSMMove(void)
 //
 void MeshViewerWidget::SetSMUpdegree(void)
 {
+	auto before = cage_state();
 	std::cout << "!" << std::endl;
 	calculate_green_weight327();//ȼ3cage7οƵȨ
-	auto curvecage7 = curvecage2;
-	Bezier2Bezier7(curvecage2, curvecage7);
-	curvecage2 = curvecage7;
-	//ͨcurvecage2cc_points;
-	CC_points.clear();
-	for (int i = 0; i < curvecage2.size(); i++) {
-		for (int j = 0; j < todegree; j++) {
-			CC_points.push_back(curvecage2[i][j]);
-		}
-	}
-	CC_mesh = createMeshFromCurveCage(CC_points);
-	auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-	for (auto vh : CC_mesh.vertices())
-	{
-		CagevertexState[vh] = NotSelected;
-	}
+	auto curvecage7 = cage.Bezier();
+	Bezier2Bezier7(cage.Bezier(), curvecage7);
+	cage.Reset(curvecage7);//7εĸλµcage
 	highdegree = true;
+	history.PushRebuild(before, cage_state());
 	update();
 }
 
 //
 void MeshViewerWidget::SetSMChangedegree(void)
 {
+	auto before = cage_state();
 	todegree = 2;
 	highdegree = true;
 	std::cout << "׵" << todegree << std::endl;
+	std::vector<Mesh::Point> CC_points;
+	auto curvecage2 = cage.Bezier();//ڸϱף廻µcage
 	auto curvecage1 = curvecage2;
 	if (degree == 2) {
 		if (todegree == 1) {
@@ -286,8 +293,8 @@ void MeshViewerWidget::SetSMChangedegree(void)
 	OpenMesh::Vec3d(0.512756, -0.0850323, 0),
 				};
 			}
-			CC_mesh = createMeshFromCurveCage(CC_points);
-			curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
+			cage.Reset(CC_points, degree);
+			curvecage2 = cage.Bezier();
 			Bezier2Bezier321(curvecage2, curvecage1);
 			curvecage2 = curvecage1;
 		}
@@ -332,8 +339,8 @@ void MeshViewerWidget::SetSMChangedegree(void)
 	OpenMesh::Vec3d(0.512756, -0.0850323, 0),
 				};
 			}
-			CC_mesh = createMeshFromCurveCage(CC_points);
-			curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
+			cage.Reset(CC_points, degree);
+			curvecage2 = cage.Bezier();
 			Bezier2Bezier322(curvecage2, curvecage1);
 			curvecage2 = curvecage1;
 		}
@@ -378,26 +385,15 @@ void MeshViewerWidget::SetSMChangedegree(void)
 	OpenMesh::Vec3d(0.512756, -0.0850323, 0),
 				};
 			}
-			CC_mesh = createMeshFromCurveCage(CC_points);
-			curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
+			cage.Reset(CC_points, degree);
+			curvecage2 = cage.Bezier();
 			Bezier2Bezier7(curvecage2, curvecage1);
 			curvecage2 = curvecage1;
 		}
 	}
-	//ͨcurvecage2cc_points;
-	CC_points.clear();
-	for (int i = 0; i < curvecage2.size(); i++) {
-		for (int j = 0; j < todegree; j++) {
-			CC_points.push_back(curvecage2[i][j]);
-		}
-	}
-	CC_mesh = createMeshFromCurveCage(CC_points);
-	auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-	for (auto vh : CC_mesh.vertices())
-	{
-		CagevertexState[vh] = NotSelected;
-	}
+	cage.Reset(curvecage2);//todegree
 	//highdegree = true;
+	history.PushRebuild(before, cage_state());
 	update();
 }
 
@@ -414,36 +410,250 @@ void MeshViewerWidget::SetSMNodrawpoint(void)
 void MeshViewerWidget::SetSMAddpoints(void)
 {
 	std::cout << "add points!" << std::endl;
-	auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
+	std::vector<int> selected;
+	cage.SelectedIds(selected);
 	int vertex_index;
-	for (auto vh : CC_mesh.vertices())
+	if (!selected.empty())
 	{
-		if (CagevertexState[vh] == Custom) {
-			vertex_index = vh.idx();
-		}
-		
+		vertex_index = selected.back();
+	}
+	else
+	{
+		//ûѡеĿƵʱϴ˫һ
+		if (!hasClickCor || cage.SegmentCount() == 0)
+			return;
+		cageBVH.Refit(cage);
+		int s;
+		double dist, t;
+		cageBVH.NearestSegments(&lastClickCor, 1, &s, &dist, &t, cage.MeanEdgeLength() * 0.5);
+		if (s < 0)
+			return;
+		//tڵƶεı
+		int d = cage.SegmentDegree(s);
+		vertex_index = (cage.Offset(s) + std::min(int(t * d), d - 1)) % cage.Size();
 	}
 	// Get the points at vertex_index and vertex_index + 1
-	Mesh::Point p1 = CC_points[vertex_index];
-	Mesh::Point p2 = CC_points[vertex_index + 1];
+	Mesh::Point p1 = cage.At(vertex_index);
+	Mesh::Point p2 = cage.At((vertex_index + 1) % cage.Size());
 
 	// Calculate the three division points
 	Mesh::Point p1_third = p1 + (p2 - p1) / 4.0f;
 	Mesh::Point p2_third = p1 + 2.0f * (p2 - p1) / 4.0f;
 	Mesh::Point p3_third = p1 + 3.0f * (p2 - p1) / 4.0f;
 
-	// Insert the three points into the vector
-	CC_points.insert(CC_points.begin() + vertex_index + 1, p3_third); // Insert third division point
-	CC_points.insert(CC_points.begin() + vertex_index + 1, p2_third); // Insert second division point
-	CC_points.insert(CC_points.begin() + vertex_index + 1, p1_third); // Insert first division point
-	
-	CC_mesh = createMeshFromCurveCage(CC_points);
-	CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-	for (auto vh : CC_mesh.vertices())
+	if (session.Recording())
+	{
+		//¼ֻ϶ƵıطʱcageٶӦ
+		session.End();
+		std::cout << "control points added, drag recording discarded" << std::endl;
+	}
+	// Insert the three points after vertex_index, the segments are laid out again
+	cage.Insert(vertex_index + 1, { p1_third, p2_third, p3_third });
+	history.PushInsert(vertex_index + 1, { p1_third, p2_third, p3_third });
+
+	update();
+}
+
+void MeshViewerWidget::SetSMMVCPreview(void)
+{
+	mvcpreview = !mvcpreview;
+	std::cout << "mvc preview " << (mvcpreview ? "on" : "off") << std::endl;
+}
+
+void MeshViewerWidget::SetSMDistortion(void)
+{
+	drawdistortion = !drawdistortion;
+	if (drawdistortion)
+		metrics.Update(mesh);
+	emit DistortionInfoSignal(drawdistortion ? DistortionInfo() : QString());
+	update();
+}
+
+//һcage༭ָֻƵ㣨ȨصļʱͬʱȨأȨֵ
+void MeshViewerWidget::SetSMUndo(void)
+{
+	if (isMovable)
+		return;
+	const CageHistory::Step* step = history.Undo();
+	if (step)
+		apply_history_step(*step, true);
+	else
+		std::cout << "nothing to undo" << std::endl;
+}
+
+void MeshViewerWidget::SetSMRedo(void)
+{
+	if (isMovable)
+		return;
+	const CageHistory::Step* step = history.Redo();
+	if (step)
+		apply_history_step(*step, false);
+	else
+		std::cout << "nothing to redo" << std::endl;
+}
+
+//ģʽcage֮ARAPرʱָcageεĽ
+void MeshViewerWidget::SetSMArapRefine(void)
+{
+	araprefine = !araprefine;
+	if (araprefine)
+	{
+		arap.Factorize();//϶ĵһֽ֡
+		refine_arap(mesh);
+	}
+	else
+		arap.Restore(mesh.points(), int(mesh.n_vertices()));
+	std::cout << "arap refine " << (araprefine ? "on" : "off") << std::endl;
+	update();
+}
+
+//ǰĿƵΪһؼ֡һ1
+void MeshViewerWidget::SetSMAddKeyframe(void)
+{
+	double t = animation.Keyframes().empty() ? 0.0 : animation.EndTime() + 1;
+	animation.AddKeyframe(t, cage.Points());
+	std::cout << "keyframe " << animation.Keyframes().size() << " at " << t << " s" << std::endl;
+}
+
+//Ⱦؼ֡ûйؼ֡ʱļ루ɿʱӡĸʽÿ֡дһļ
+void MeshViewerWidget::SetSMRenderAnimation(void)
+{
+	if (animation.Keyframes().empty())
+	{
+		QString keys = QFileDialog::getOpenFileName(this, tr("Open keyframes"), strMeshPath, tr("Keyframes (*.txt);;All Files (*)"));
+		if (keys.isEmpty() || !animation.LoadKeyframes(keys.toStdString()))
+			return;
+	}
+	QString out = QFileDialog::getSaveFileName(this, tr("Save animation frames"), strMeshPath + "/" + strMeshBaseName + ".obj",
+		tr("OBJ Files (*.obj);;OFF Files (*.off);;PLY Files (*.ply);;All Files (*)"));
+	if (out.isEmpty())
+		return;
+	QFileInfo fi(out);
+	std::string prefix = (fi.path() + "/" + fi.completeBaseName()).toStdString();
+	std::string suffix = "." + fi.suffix().toStdString();
+
+	//д߳Լ񣬰ļеĶ˳д
+	Mesh frameMesh;
+	std::vector<int> order;
+	if (vertexOrder.size() == mesh.n_vertices())
+	{
+		MeshTools::RestoreVertexOrder(mesh, vertexOrder, frameMesh);
+		order = vertexOrder;
+	}
+	else
+	{
+		frameMesh.assign(mesh);
+	}
+	auto write = [&](int frame, const Mesh::Point* pts) {
+		for (int i = 0; i < frameMesh.n_vertices(); i++)
+		{
+			frameMesh.set_point(frameMesh.vertex_handle(order.empty() ? i : order[i]), pts[i]);
+		}
+		char number[16];
+		std::snprintf(number, sizeof(number), "_%04d", frame);
+		return MeshTools::WriteMesh(frameMesh, prefix + number + suffix, DBL_DECIMAL_DIG);
+	};
+	auto deform = [this](const std::vector<std::vector<Mesh::Point>>& poses, std::vector<Mesh::Point>& frames) {
+		return deform_poses(poses, frames);
+	};
+	QElapsedTimer timer;
+	timer.start();
+	int n = animation.Render(CageAnimation::kDefaultFps, deform, write);
+	if (n < 0)
+		std::cout << "animation failed" << std::endl;
+	else
+		std::cout << n << " frames written to " << prefix << "_*" << suffix << " in " << timer.elapsed() << " ms" << std::endl;
+}
+
+//ʼ/¼϶ʱ¼ͬǰȨдỰļ֮޽طţSurfaceMeshProcessing --replay ļ
+void MeshViewerWidget::SetSMRecordSession(void)
+{
+	if (!session.Recording())
+	{
+		if (weights.rows() == 0 || weights.rows() != mesh.n_vertices())
+		{
+			std::cout << "record: calculate the weights first" << std::endl;
+			return;
+		}
+		session.Begin(strMeshFileName.toStdString(), int(mesh.n_vertices()), cage.Points(), highdegree ? todegree : degree,
+			usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis);
+		std::cout << "recording drags" << std::endl;
+		return;
+	}
+	session.End();
+	QString file = QFileDialog::getSaveFileName(this, tr("Save drag session"), strMeshPath + "/" + strMeshBaseName + ".pgcs",
+		tr("Drag Sessions (*.pgcs);;All Files (*)"));
+	if (file.isEmpty())
+		return;
+	if (session.Save(file.toStdString(), weights, outsideVertices))
+		std::cout << session.Events() << " events saved to " << file.toStdString() << std::endl;
+}
+
+//cageһΰʱһ˫λ÷һԲεcageֻڲȨأ֮ڱ༭cage͸cage֮л
+void MeshViewerWidget::SetSMSubCage(void)
+{
+	if (subCage.Empty())
+	{
+		if (mesh.n_vertices() == 0)
+			return;
+		deformWorker.Stop();
+		Mesh::Point c = hasClickCor ? lastClickCor : (ptMin + ptMax) / 2;
+		c[2] = 0;
+		//ĶBezierƵԲ
+		double r = (ptMax - ptMin).norm() * 0.08;
+		double k = 0.5523 * r;
+		std::vector<Mesh::Point> ccPoints = {
+			c + Mesh::Point(r, 0, 0), c + Mesh::Point(r, k, 0), c + Mesh::Point(k, r, 0),
+			c + Mesh::Point(0, r, 0), c + Mesh::Point(-k, r, 0), c + Mesh::Point(-r, k, 0),
+			c + Mesh::Point(-r, 0, 0), c + Mesh::Point(-r, -k, 0), c + Mesh::Point(-k, -r, 0),
+			c + Mesh::Point(0, -r, 0), c + Mesh::Point(k, -r, 0), c + Mesh::Point(r, -k, 0)
+		};
+		int n = subCage.Build(mesh, ccPoints, 3, outsideVertices);
+		if (n == 0)
+		{
+			std::cout << "sub cage: no vertices inside, double-click where it should go" << std::endl;
+			return;
+		}
+		subCagePoints.Reset(subCage.Points(), 3);
+		editSubCage = true;
+		std::cout << "sub cage over " << n << " of " << mesh.n_vertices() << " vertices" << std::endl;
+	}
+	else
 	{
-		CagevertexState[vh] = NotSelected;
+		editSubCage = !editSubCage;
 	}
+	std::cout << (editSubCage ? "editing the sub cage" : "editing the parent cage") << std::endl;
+	update();
+}
 
+//ͼ㣺meshcageһȡİΧУԵǰcageΪֹ״̬ͼȨһ
+void MeshViewerWidget::SetSMAddLayer(void)
+{
+	QString file = QFileDialog::getOpenFileName(this, tr("Open layer mesh"), strMeshPath,
+		tr("OBJ Files (*.obj);;OFF Files (*.off);;PLY Files (*.ply);;All Files (*)"));
+	if (file.isEmpty())
+		return;
+	Mesh layerMesh;
+	std::vector<int> order;
+	if (!MeshTools::ReadMesh(layerMesh, file.toStdString(), &order))
+	{
+		std::cout << "cannot read layer " << file.toStdString() << std::endl;
+		return;
+	}
+	QString image = QFileDialog::getOpenFileName(this, tr("Open layer texture"), strMeshPath,
+		tr("Images (*.png *.jpg *.bmp);;All Files (*)"));
+	unsigned int texture = image.isEmpty() ? glTextureID : load_layer_texture(image.toStdString());
+	Mesh::Point bmin, bmax;
+	MeshTools::BoundingBox(layerMesh, bmax, bmin);
+	layerMesh.request_vertex_texcoords2D();
+	for (auto vh : layerMesh.vertices())
+	{
+		Mesh::Point P = layerMesh.point(vh) - bmin;
+		layerMesh.set_texcoord2D(vh, Mesh::TexCoord2D(P[0] / std::max(bmax[0] - bmin[0], 1e-12), P[1] / std::max(bmax[1] - bmin[1], 1e-12)));
+	}
+	deformWorker.Stop();
+	layers.Add(QFileInfo(file).baseName().toStdString(), layerMesh, texture);
+	layers.Bind(cage.Bezier(), [this](const Mesh::Point* pts, int n, WeightMatrix& W) { layer_weights(pts, n, W); });
 	update();
 }
 
@@ -457,6 +667,7 @@ void MeshViewerWidget::SetSMNoSelect(void)
 
 void MeshViewerWidget::ClearSelected(void)
 {
+	auto before = cage_state();
 	/*auto vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(mesh, "vertexState");
 	for (auto vh : mesh.vertices())
 	{
@@ -465,7 +676,7 @@ void MeshViewerWidget::ClearSelected(void)
 	Mesh deformedMesh;
 	deformedMesh.assign(mesh);
 
-	CC_points = { //deer
+	std::vector<Mesh::Point> CC_points = { //deer
 OpenMesh::Vec3d(8.01426, -9.42736, 0),
 OpenMesh::Vec3d(8.33338, -9.22516, 0),
 OpenMesh::Vec3d(8.57722, -9.0101, 0),
@@ -1552,18 +1763,10 @@ OpenMesh::Vec3d(7.20539, -8.66758, 0),
 //OpenMesh::Vec3d(18.353, -8.94576, 0),
 //OpenMesh::Vec3d(15.939, -2.21534, 0),
 //};
-	CC_mesh = createMeshFromCurveCage(CC_points);
-	auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-	for (auto vh : CC_mesh.vertices())
-	{
-		CagevertexState[vh] = NotSelected;
-	}
-	if (!highdegree)
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-	else
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, todegree);
+	cage.Reset(CC_points, highdegree ? todegree : degree);
 	deform_mesh_from_cc(deformedMesh);//ͨımeshĶλ
 	MeshTools::AssignPoints(mesh, deformedMesh);
+	history.PushRebuild(before, cage_state());
 	update();
 }
 
@@ -1580,20 +1783,33 @@ bool MeshViewerWidget::event(QEvent* _event)
 			WinCor2ObjCor(winCor.x(), winCor.y(), objCor, depth);
 			objCor = OpenMesh::Vec3d{ objCor[0],objCor[1],0 };
 
-			OpenMesh::VertexHandle minVh;
-			if (NearestCageVertex(objCor, minVh))
+			int minId;
+			if (NearestCageVertex(objCor, minId))
 			{
-				auto vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-				if (vertexState[minVh] == Custom)
+				if ((editSubCage ? subCagePoints : cage).Selected(minId))
 				{
 					isMovable = true;
 					moveDepth = depth;
 					lastObjCor = objCor;
+					begin_cage_drag();
+					if (editSubCage)
+						return true;
+					session.Record(DragSession::Press, movingCagePoints.data(), int(movingCagePoints.size()));
+					if (mvcpreview)
+					{
+						//϶ʼʱڿƶεMVCȨ
+						previewWeights.setZero(mesh.n_vertices(), cage.Size());
+						MVC::meanValueCoords(cage.Points(), mesh.points(), mesh.n_vertices(), previewWeights.data(), previewWeights.cols());
+					}
+					else
+					{
+						start_deform_worker();
+					}
 					return true;
 				}
 			}
 		}
-		if (selectMode == SelectAdjust)
+		if (selectMode == SelectAdjust && !editSubCage)
 		{
 			auto e = static_cast<QMouseEvent*>(_event);
 			QPoint winCor = e->pos();
@@ -1602,15 +1818,15 @@ bool MeshViewerWidget::event(QEvent* _event)
 			WinCor2ObjCor(winCor.x(), winCor.y(), objCor, depth);
 			objCor = OpenMesh::Vec3d{ objCor[0],objCor[1],0 };
 
-			OpenMesh::VertexHandle minVh;
-			if (NearestCageVertex(objCor, minVh))
+			int minId;
+			if (NearestCageVertex(objCor, minId))
 			{
-				auto vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-				if (vertexState[minVh] == Custom)
+				if (cage.Selected(minId))
 				{
 					isMovable = true;
 					moveDepth = depth;
 					lastObjCor = objCor;
+					begin_cage_drag();
 					return true;
 				}
 			}
@@ -1630,46 +1846,30 @@ bool MeshViewerWidget::event(QEvent* _event)
 
 			auto moveVec = objCor - lastObjCor;
 			lastObjCor = objCor;
-			Mesh deformedMesh;
-			deformedMesh.assign(mesh);
-			auto vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(mesh, "vertexState");
-			for (auto vh_ : deformedMesh.vertices())
-			{
-				if (vertexState[mesh.vertex_handle(vh_.idx())] != Custom)
-				{
-					deformedMesh.set_point(vh_, deformedMesh.point(vh_) + moveVec);
-				}
-			}
-			
-			MeshTools::AssignPoints(mesh, deformedMesh);
-			//for cage mesh
-			//Mesh deformedCCMesh;
-			//deformedCCMesh.assign(CC_mesh);
-			auto CCvertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-			for (auto vh_ : CC_mesh.vertices())
+			if (editSubCage)
 			{
-				if (CCvertexState[CC_mesh.vertex_handle(vh_.idx())] == Custom)
-				{
-					CC_mesh.set_point(vh_, CC_mesh.point(vh_) + moveVec);
-					int vertex_id = vh_.idx();
-					CC_points[vertex_id] = CC_points[vertex_id] + moveVec;
-				}
-			}
-			
-			
-			//MeshTools::AssignPoints(CC_mesh, deformedCCMesh);
-			if (!highdegree)
-			{
-				auto deformedcurvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-				curvecage2 = deformedcurvecage2;
+				//cageֻƶֲƵ㣬ػʱֻڲĶ
+				subCage.MovePoints(movingCagePoints.data(), int(movingCagePoints.size()), moveVec);
+				sync_sub_cage_points();
+				dragMoves++;
+				deformPending = true;
+				update();
+				return true;
 			}
-			else
+			//ֻ±϶ĿƵõǵĶΣ϶вڴ
+			cage.MovePoints(movingCagePoints.data(), int(movingCagePoints.size()), moveVec);
+			dragMoves++;
+			session.Record(DragSession::Move, nullptr, 0, moveVec);
+			if (deformWorker.Running())
 			{
-				auto deformedcurvecage2 = CCpoints_fromCCmesh(CC_mesh, todegree);
-				curvecage2 = deformedcurvecage2;
+				//ֻ̨̣߳µλûᱻΣػʱȡ
+				deformWorker.Post(cage.Points());
+				update();
+				return true;
 			}
-			deform_mesh_from_cc(deformedMesh);//ͨımeshĶλ
-			MeshTools::AssignPoints(mesh, deformedMesh);
+			//ֻµĿƵ㣬ػʱУupdate()ϲһ֡ڵĶÿ֡һ
+			//ػʱCageDeformercageȡڼĶΣмλòӰս
+			deformPending = true;
 			update();
 			return true;
 		}
@@ -1686,24 +1886,15 @@ bool MeshViewerWidget::event(QEvent* _event)
 			auto moveVec = objCor - lastObjCor;
 			lastObjCor = objCor;
 			moveVec = moveVec / 2;
-			//for cage mesh
-			//Mesh deformedCCMesh;
-			//deformedCCMesh.assign(CC_mesh);
-			auto CCvertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-			for (auto vh_ : CC_mesh.vertices())
+			if (session.Recording())
 			{
-				if (CCvertexState[CC_mesh.vertex_handle(vh_.idx())] == Custom )
-				{
-					CC_mesh.set_point(vh_, CC_mesh.point(vh_) + moveVec);
-					int vertex_id = vh_.idx();
-					CC_points[vertex_id] = CC_points[vertex_id] + moveVec;
-				}
+				//cage񲻶طʱcage֮¼϶Բ
+				session.End();
+				std::cout << "cage adjusted, drag recording discarded" << std::endl;
 			}
-
-
-			//MeshTools::AssignPoints(CC_mesh, deformedCCMesh);
-			auto deformedcurvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-			curvecage2 = deformedcurvecage2;
+			//񲻶ֻƶĶڻƺԽʱȡ
+			cage.MovePoints(movingCagePoints.data(), int(movingCagePoints.size()), moveVec);
+			check_cage_self_intersection();
 			
 			update();
 			return true;
@@ -1714,18 +1905,54 @@ bool MeshViewerWidget::event(QEvent* _event)
 		
 		if (selectMode == Move && isMovable)
 		{
+			bool workerDrag = deformWorker.Running() && !proxyActive;
+			deformWorker.Stop();//һλñ
+			session.Record(DragSession::Release);
+			apply_pending_deformation();
+			if (workerDrag)
+				refine_arap(mesh);//̵̨߳֡ûARAPɿʱһ֡һ
+			if (proxyActive)
+			{
+				proxyActive = false;
+				deform_full_resolution();
+				std::cout << "proxy mesh: " << proxy.GetMesh().n_vertices() << " of " << mesh.n_vertices()
+					<< " vertices, largest jump on release " << proxy.Mismatch(mesh) << std::endl;
+				update();
+			}
+			//ÿ֡Ԥ㰴60Hz
+			std::cout << "drag: " << dragMoves << " moves, " << dragFrames << " deformations, "
+				<< (dragFrames ? dragDeformMs / dragFrames : 0.0) << " ms average, " << dragMaxDeformMs << " ms max (frame budget "
+				<< 1000.0 / 60 << " ms)" << std::endl;
+			if (mvcpreview)
+			{
+				Mesh deformedMesh;
+				deformedMesh.assign(mesh);
+				deform_mesh_from_cc(deformedMesh);
+				MeshTools::AssignPoints(mesh, deformedMesh);
+				deform_layers(cageDeformer.Coefficients());
+				update();
+			}
+			if (!editSubCage && !subCage.Empty())
+			{
+				//cage϶cageľֲȨ򶥵λ㣬϶ֻǴžɵλ
+				rebind_sub_cage();
+				update();
+			}
 			std::cout << "{";
-			for (const auto& point : CC_points) {
+			for (const auto& point : cage.Points()) {
 				std::cout << "OpenMesh::Vec3d(" << point[0] << ", " << point[1] << ", " << point[2] << ")," << std::endl;
 			}
 			std::cout << "}" << std::endl;
+			record_cage_move(false);
 			isMovable = false;
 			return true;
 		}
 		if (selectMode == SelectAdjust)
 		{
+			if (isMovable)
+				record_cage_move(true);
 			std::cout << "{";
-			for (const auto& point : CC_points) {
+			for (const auto& point : cage.Points()) {
 				std::cout << "OpenMesh::Vec3d(" << point[0] << ", " << point[1] << ", " << point[2] << ")," << std::endl;
 			}
 			std::cout << "}" << std::endl;
@@ -1736,6 +1963,16 @@ bool MeshViewerWidget::event(QEvent* _event)
 	return QGLViewerWidget::event(_event);
 }
 
+void MeshViewerWidget::keyPressEvent(QKeyEvent* _event)
+{
+	if (_event->matches(QKeySequence::Undo))
+		SetSMUndo();
+	else if (_event->matches(QKeySequence::Redo))
+		SetSMRedo();
+	else
+		QGLViewerWidget::keyPressEvent(_event);
+}
+
 void MeshViewerWidget::mouseDoubleClickEvent(QMouseEvent* _event)
 {
 	switch (selectMode)
@@ -1751,33 +1988,14 @@ void MeshViewerWidget::mouseDoubleClickEvent(QMouseEvent* _event)
 		double depth;
 		OpenMesh::Vec3d objCor;
 		WinCor2ObjCor(winCor.x(), winCor.y(), objCor, depth);
-		OpenMesh::VertexHandle minVh;
+		lastClickCor = OpenMesh::Vec3d{ objCor[0],objCor[1],0 };//µcage
+		hasClickCor = true;
+		int minId;
 
-		if (NearestCageVertex(objCor,minVh))
+		if (NearestCageVertex(objCor, minId))
 		{
-			auto vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-			if (selectMode == SelectAdjust)
-			{
-				if (vertexState[minVh] == NotSelected)
-				{
-					vertexState[minVh] = Custom;
-				}
-				else if (vertexState[minVh] == Custom)
-				{
-					vertexState[minVh] = NotSelected;
-				}
-			}
-			else if (selectMode == SelectCustom)
-			{
-				if (vertexState[minVh] == NotSelected)
-				{
-					vertexState[minVh] = Custom;
-				}
-				else if (vertexState[minVh] == Custom)
-				{
-					vertexState[minVh] = NotSelected;
-				}
-			}
+			//ģʽ˫лƵѡ״̬
+			(editSubCage ? subCagePoints : cage).Toggle(minId);
 			update();
 		}
 		break;
@@ -1791,6 +2009,7 @@ void MeshViewerWidget::mouseDoubleClickEvent(QMouseEvent* _event)
 
 void MeshViewerWidget::DrawScene(void)
 {
+	apply_pending_deformation();
 	glMatrixMode(GL_PROJECTION);
 	glLoadMatrixd(&projectionmatrix[0]);
 	glMatrixMode(GL_MODELVIEW);
@@ -1840,6 +2059,9 @@ void MeshViewerWidget::DrawSceneMesh(void)
 void MeshViewerWidget::CurveCage_Test(void)
 {
 	drawmode = CURVECAGE;
+	std::vector<std::vector<Mesh::Point>> curvecage2;//cageﹹ죬ٽcage
+	std::vector<Mesh::Point> CC_points;
+	history.Clear();//µcage֮ǰı༭
 	degree = 3;
 
 	if (degree==2)//if mode
@@ -1914,13 +2136,7 @@ OpenMesh::Vec3d(-2.39632, -3.96978, 0),
 OpenMesh::Vec3d(-0.151571, -4.57271, 0),
 		};
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight222();//2cage2οƵȨ
 		
 	}
@@ -2521,13 +2737,7 @@ OpenMesh::Vec3d(4.89491, -9.35694, 0),
 //OpenMesh::Vec3d(19.5164, -2.8494, 0),
 //OpenMesh::Vec3d(19.745, 1.90087, 0),
 //};
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight323();//3cage3οƵȨ
 	}
 
@@ -2539,6 +2749,8 @@ void MeshViewerWidget::CubicMVC_Test(void)
 {
 	std::cout << "CubicMVC!" << std::endl;
 	drawmode = CURVECAGE;
+	std::vector<std::vector<Mesh::Point>> curvecage2;//cageﹹ죬ٽcage
+	std::vector<Mesh::Point> CC_points;
 	usecvm = true;
 	auto arthono = [](const OpenMesh::Vec3d& p) -> OpenMesh::Vec3d {//left( -y, x)
 		return OpenMesh::Vec3d(p[1],- p[0], p[2]);
@@ -2683,113 +2895,101 @@ void MeshViewerWidget::CubicMVC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
-
-		std::vector<OpenMesh::Vec3d> t_e(N);
-		std::vector<OpenMesh::Vec3d> n_e(N);
-		mvcGn.resize(2 * N);
-		mvcGt.resize(2 * N);
-		mvcL.resize(N);
-		
-		std::vector<double> vc(N);
-		std::vector<double> gnc(2 * N);
-		std::vector<double> gtc(2 * N);
-		OpenMesh::Vec3d ptest = OpenMesh::Vec3d(1.1, 1, 0);
-		MVC::cubicMVCs(polygon_vertices, ptest, vc, gnc, gtc);
-		OpenMesh::Vec3d r_test = OpenMesh::Vec3d(0, 0, 0);
-
-		std::vector<double> L(N);
-		for (int i = 0; i < N; i++)
-		{
-			mvcGt[2 * i] = 3*(curvecage2[i][1] - curvecage2[i][0])/norm(curvecage2[i][3] - curvecage2[i][0]);
-			mvcGt[2 * i + 1] = 3*(curvecage2[i][2] - curvecage2[i][3]) / norm(curvecage2[i][3] - curvecage2[i][0]);
-			mvcL[i] = (curvecage2[i][3] - curvecage2[i][0]).norm();//ÿߵĳ
-			n_e[i] = arthono((curvecage2[i][3] - curvecage2[i][0])).normalized();//ÿߵĵλ
-			t_e[i] = (curvecage2[i][3] - curvecage2[i][0]).normalized();//ÿߵĵλ
-		}
-		auto f = polygon_vertices;
-		auto df = mvcGt;
-		auto h = mvcGt;
-		//h
-		for (int i = 0; i < N; i++)
-		{
-			int index = (i - 1) % N;
-			if (index < 0) {
-				index += N;
-			}
-			Eigen::Matrix2d A;
-			Eigen::Matrix2d B;
-			OpenMesh::Vec3d Bx = -mvcGt[2 * index + 1][0] * t_e[index] - mvcGt[2 * i][0] * t_e[i];
-			OpenMesh::Vec3d By = -mvcGt[2 * index + 1][1] * t_e[index] - mvcGt[2 * i][1] * t_e[i];
-			// ΪABֵ
-			A << n_e[i][0], -n_e[index][0],
-				n_e[i][1], -n_e[index][1];
-			B << Bx[0], By[0],
-				Bx[1], By[1];
-			//solve gn
-			Eigen::Matrix2d X = A.inverse() * B;
-			//std::cout << X << std::endl;
-			mvcGn[2 * index + 1] = OpenMesh::Vec3d(X(1, 0), X(1, 1), 0);
-			mvcGn[2 * i] = OpenMesh::Vec3d(X(0, 0), X(0, 1), 0);
-			/*std::cout <<"xݶ" << gt[2 * i][0] * t_e[i] + gn[2 * i][0] * n_e[i] << std::endl;
-			std::cout << "yݶ" << gt[2 * i][1] * t_e[i] + gn[2 * i][1] * n_e[i] << std::endl;
-			std::cout << gt[2 * i][0] * t_e[i] + gn[2 * i][0] * n_e[i] - (-gt[2 * index + 1][0] * t_e[index] + gn[2 * index + 1][0] * n_e[index]) << std::endl;
-			std::cout << gt[2 * i][1] * t_e[i] + gn[2 * i][1] * n_e[i] - (-gt[2 * index + 1][1] * t_e[index] + gn[2 * index + 1][1] * n_e[index]) << std::endl;*/
-
-		}
-		
-		for (int i = 0; i < N; i++)
-		{
-			r_test += vc[i] * polygon_vertices[i];
-			r_test += gtc[2 * i] * mvcGt[2 * i];
-			r_test += gtc[2 * i + 1] * mvcGt[2 * i + 1];
-			r_test += gnc[2 * i] * mvcGn[2 * i];
-			r_test += gnc[2 * i + 1] * mvcGn[2 * i + 1];
-		}
-		std::cout << r_test - ptest << std::endl;
-		//ͨcurvecage2cc_points;
-		for (int i = 0; i < N; i++) {
-			for (int j = 0; j < degree; j++) {
-				CC_points.push_back(curvecage2[i][j]);
-			}
-		}
+		cage.Reset(CC_points, degree);
 
 		//calculate_green_weight123();//3cage3οƵȨ
-		weights.resize(mesh.n_vertices(), std::vector<double>(5 * curvecage2.size(), 0.0));
+		reset_weights(5 * curvecage2.size());
+		//ÿΪ [vc, gt0, gt1, gn0, gn1]ֱдweights
+		MVC::cubicMVCs(polygon_vertices, mesh.points(), mesh.n_vertices(), weights.data(), weights.cols());
+		fold_cubicmvc_weights();
+		double max_err = 0;
 		for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {
-			N = curvecage2.size();
-			std::vector<double> vc(N);
-			std::vector<double> gnc(2 * N);
-			std::vector<double> gtc(2 * N);
-			auto vh = mesh.vertex_handle(v_id);
-			Mesh::Point eta = mesh.point(vh);
-			MVC::cubicMVCs(polygon_vertices, eta, vc, gnc, gtc);
-			for (int i = 0; i < curvecage2.size(); i++)
+			Mesh::Point eta = mesh.point(mesh.vertex_handle(v_id));
+			Mesh::Point test_eta(0, 0, eta[2]);//check equality
+			for (int j = 0; j < N; j++)
 			{
-				weights[v_id][5 * i] = vc[i];
-				weights[v_id][5 * i + 1] = gtc[2 * i];
-				weights[v_id][5 * i + 2] = gtc[2 * i + 1];
-				weights[v_id][5 * i + 3] = gnc[2 * i];
-				weights[v_id][5 * i + 4] = gnc[2 * i + 1];
+				for (int m = 0; m < 3; m++)
+				{
+					test_eta += weights(v_id, 3 * j + m) * curvecage2[j][m];
+				}
 			}
-
+			if ((test_eta - eta).norm() > max_err)
+				max_err = (test_eta - eta).norm();
 		}
+		std::cout << "max norm err:" << max_err << std::endl;
 		Set_Texture_coord();//
 
 	}
 }
 
+//MVCgtǿƵĲ֣ǵ㴦gn2x2ϵͳA*X=BAֹֻcage
+//gnҲǿƵĹ̶ϡ [vc, gt0, gt1, gn0, gn1] Ȩسӳ䣬
+//֮weightsÿжӦcurvecage2[j][0..2]϶ʱֻһξ˷
+void MeshViewerWidget::fold_cubicmvc_weights(void)
+{
+	assert(weights.cols() == 5 * cage.SegmentCount());
+	WeightMatrix folded = weights * cubicmvc_fold();
+	weights.swap(folded);
+}
+
+//ӳ䣺5N x 3NNΪ
+Eigen::MatrixXd MeshViewerWidget::cubicmvc_fold(void) const
+{
+	const auto& curvecage2 = cage.Bezier();
+	auto arthono = [](const OpenMesh::Vec3d& p) -> OpenMesh::Vec3d {
+		return OpenMesh::Vec3d(p[1], -p[0], p[2]);
+	};
+	int N = curvecage2.size();
+	//jεĵmƵctpsеУm = 3ʱΪһε
+	auto ctp = [N](int j, int m) { return 3 * ((j + m / 3) % N) + m % 3; };
+
+	std::vector<OpenMesh::Vec3d> t_e(N);
+	std::vector<OpenMesh::Vec3d> n_e(N);
+	Eigen::MatrixXd Gt = Eigen::MatrixXd::Zero(2 * N, 3 * N);
+	for (int j = 0; j < N; j++)
+	{
+		OpenMesh::Vec3d e = curvecage2[j][3] - curvecage2[j][0];
+		double s = 3 / e.norm();
+		t_e[j] = e.normalized();//ÿߵĵλ
+		n_e[j] = arthono(e).normalized();//ÿߵĵλ
+		Gt(2 * j, ctp(j, 1)) += s;
+		Gt(2 * j, ctp(j, 0)) -= s;
+		Gt(2 * j + 1, ctp(j, 2)) += s;
+		Gt(2 * j + 1, ctp(j, 3)) -= s;
+	}
+	Eigen::MatrixXd Gn = Eigen::MatrixXd::Zero(2 * N, 3 * N);
+	for (int i = 0; i < N; i++)
+	{
+		int index = (i + N - 1) % N;
+		Eigen::Matrix2d A;
+		A << n_e[i][0], -n_e[index][0],
+			n_e[i][1], -n_e[index][1];
+		Eigen::Matrix2d invA = A.inverse();
+		//B = -t_index * gt[2index+1]^T - t_i * gt[2i]^T
+		Eigen::Vector2d u = invA * Eigen::Vector2d(t_e[index][0], t_e[index][1]);
+		Eigen::Vector2d v = invA * Eigen::Vector2d(t_e[i][0], t_e[i][1]);
+		Gn.row(2 * i) = -u(0) * Gt.row(2 * index + 1) - v(0) * Gt.row(2 * i);
+		Gn.row(2 * index + 1) = -u(1) * Gt.row(2 * index + 1) - v(1) * Gt.row(2 * i);
+	}
+	Eigen::MatrixXd G = Eigen::MatrixXd::Zero(5 * N, 3 * N);
+	for (int j = 0; j < N; j++)
+	{
+		G(5 * j, ctp(j, 0)) = 1;
+		G.row(5 * j + 1) = Gt.row(2 * j);
+		G.row(5 * j + 2) = Gt.row(2 * j + 1);
+		G.row(5 * j + 3) = -Gn.row(2 * j);
+		G.row(5 * j + 4) = -Gn.row(2 * j + 1);
+	}
+	return G;
+}
+
 
 //kuzi
 void MeshViewerWidget::PolyGC_Test(void)
 {
 	drawmode = CURVECAGE;
+	std::vector<std::vector<Mesh::Point>> curvecage2;//cageﹹ죬ٽcage
+	std::vector<Mesh::Point> CC_points;
 	double test = F2_n(Mesh::Point(0, 0, 0), Mesh::Point(0, 2, 0), Mesh::Point(-2, -2, 0), Mesh::Point(1, 0, 0), 1);
 
 	//˾GC
@@ -2830,13 +3030,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	//choufishGC
@@ -2879,13 +3073,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	//һGCkuzi
@@ -2942,13 +3130,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_specialgreen_weight123({0});//3cage3οƵȨ
 	}
 
@@ -3042,13 +3224,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_specialgreen_weight123({3,5,7});//3cage3οƵȨ
 	}
 
@@ -3087,13 +3263,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	//0GCfish,zoomfifh
@@ -3198,13 +3368,7 @@ void MeshViewerWidget::PolyGC_Test(void)
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_specialgreen_weight123({ 0 });//3cage3οƵȨ
 	}
 
@@ -3248,13 +3412,7 @@ OpenMesh::Vec3d(4.43436, -3.03273, 0),
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	//cage
@@ -3333,13 +3491,7 @@ OpenMesh::Vec3d(3.56099, -3.33112, 0),
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight121();//3cage3οƵȨ
 	}
 	//paristower
@@ -3377,13 +3529,7 @@ OpenMesh::Vec3d(3.56099, -3.33112, 0),
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	//paristower
@@ -3421,13 +3567,7 @@ OpenMesh::Vec3d(3.56099, -3.33112, 0),
 		}
 
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		curvecage2 = CCpoints_fromCCmesh(CC_mesh, degree);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 		calculate_green_weight123();//3cage3οƵȨ
 	}
 	Set_Texture_coord();//
@@ -3436,13 +3576,12 @@ OpenMesh::Vec3d(3.56099, -3.33112, 0),
 void MeshViewerWidget::CalculateWeight_Test(void)
 {
 	drawmode = CURVECAGE;
+	std::vector<std::vector<Mesh::Point>> curvecage2;//cageﹹ죬ٽcage
+	std::vector<Mesh::Point> CC_points;
 	if (true)//if mode
 	{
-		weights.resize(mesh.n_vertices());
 		// ÿ㣬ÿĴСΪ CC_points.size()
-		for (auto& weight : weights) {
-			weight.resize(CC_points.size());
-		}
+		reset_weights(cage.Size());
 		int N = 4;
 		curvecage2.resize(N);
 		curvecage2[0] = { OpenMesh::Vec3d(1,0,0),OpenMesh::Vec3d(1,1,0), OpenMesh::Vec3d(0,1,0) };
@@ -3455,12 +3594,7 @@ void MeshViewerWidget::CalculateWeight_Test(void)
 			}
 		}
 
-		CC_mesh = createMeshFromCurveCage(CC_points);
-		auto CagevertexState = OpenMesh::getOrMakeProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
-		for (auto vh : CC_mesh.vertices())
-		{
-			CagevertexState[vh] = NotSelected;
-		}
+		cage.Reset(CC_points, degree);
 	}
 }
 
@@ -3480,70 +3614,10 @@ void DrawPoints3d(const vector<OpenMesh::Vec3d>& Points, float r, float g, float
 	}
 }
 
-Mesh createMeshFromCurveCage(const std::vector<Mesh::Point>& curvecage2) {
-	// һ
-	Mesh mesh;
-
-	// 洢
-	std::vector<Mesh::VertexHandle> vhandles;
-
-	//  curvecage2 еĵӵĶ
-	for (const auto& point : curvecage2) {
-		vhandles.push_back(mesh.add_vertex(point));
-	}
-	
-	//// ˳ñЩ
-	//for (size_t i = 0; i < vhandles.size(); ++i) {
-	//	Mesh::VertexHandle vh0 = vhandles[i];
-	//	Mesh::VertexHandle vh1 = vhandles[i];
-	//	Mesh::VertexHandle vh2 = vhandles[(i + 1) % vhandles.size()];
-	//	std::vector<Mesh::VertexHandle> face_vhandles = { vh0, vh1, vh2 };
-	//	mesh.add_face(face_vhandles);
-	//}
-
-	return mesh;
-}
-
-std::vector<std::vector<Mesh::Point>> CCpoints_fromCCmesh(const Mesh CC_mesh,int degree) {
-	std::vector<std::vector<Mesh::Point>> CCpoints;
-	int segs = CC_mesh.n_vertices() / degree;
-	CCpoints.resize(segs);
-	for (int i = 0; i < segs; i++)
-	{
-		for (int j = 0; j < degree+1; j++)
-		{
-			if (i * degree + j == CC_mesh.n_vertices()) {
-				auto vh = CC_mesh.vertex_handle(0);
-				CCpoints[i].push_back(CC_mesh.point(vh));
-			}
-			else {
-				auto vh = CC_mesh.vertex_handle(i * degree + j);
-				CCpoints[i].push_back(CC_mesh.point(vh));
-			}
-			
-		}
-	}
-	return CCpoints;
-}
-
-std::vector<double> mvc(const Mesh::Point p, const std::vector<Mesh::Point> vts) {
-	int n_v = vts.size();
-	std::vector<double> w(n_v);
-	double sum = 0;
-	for (int i = 0; i < n_v; i++) {
-		Mesh::Point v_left = vts[(i - 1) % (n_v )];
-		Mesh::Point v = vts[i];
-		Mesh::Point v_right = vts[(i+1)%n_v];
-		double alpha_i_1 = acos((v - p).dot(v_left - p) / ((v - p).norm() * (v_left - p).norm()));
-		double alpha_i = acos((v - p).dot(v_right - p) / ((v - p).norm() * (v_right - p).norm()));
-		double wi = (tan(alpha_i_1 / 2) + tan(alpha_i / 2)) / (v - p).norm();
-		w[i] = wi;
-		sum += wi;
-
-	}
-	for (int i = 0; i < n_v; i++) {
-		w[i] /= sum;
-	}
+//MVCֱӵMVC::meanValueCoords
+std::vector<double> mvc(const Mesh::Point& p, const std::vector<Mesh::Point>& vts) {
+	std::vector<double> w(vts.size());
+	MVC::meanValueCoords(vts, &p, 1, w.data(), int(w.size()));
 	return w;
 }
 
@@ -3553,9 +3627,10 @@ double  F1_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1,
 
 	// lambda
 	auto Un = [](complex<double> x, int n) -> complex<double> {
-		complex<double> sum = 0;
+		complex<double> sum = 0, pw = 1;
 		for (int k = 1; k < n; k++) {
-			sum += std::pow(x, k) / static_cast<double>(n-k);
+			pw *= x;
+			sum += pw / static_cast<double>(n-k);
 		}
 		return sum;
 	};
@@ -3565,7 +3640,7 @@ double  F1_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1,
 	
 	complex<double> w = - com_c0/com_c1;
 	
-	double result = imag(std::pow(w, m) * (std::log(1.0 - w) - std::log(-w)) + Un(w, m));
+	double result = imag(ComplexMath::KernelMath::powi(w, m) * (ComplexMath::KernelMath::log(1.0 - w) - ComplexMath::KernelMath::log(-w)) + Un(w, m));
 	result /= imag(w);
 	result /= (2 * M_PI * norm(com_c1));//normѾƽ
 	return result;
@@ -3577,11 +3652,12 @@ double F2_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, c
 
 	// lambda
 	auto Hyper = [](complex<double> x, int n) -> complex<double> {
-		complex<double> sum = 0;
+		complex<double> sum = 0, pw = 1;
 		for (int m = 1; m <= n; ++m) {
-			sum += std::pow(x, m) / static_cast<double>(m);
+			pw *= x;
+			sum += pw / static_cast<double>(m);
 		}
-		return complex<double>(n + 1) / std::pow(x, n + 1) * (-std::log(1.0 - x) - sum);
+		return complex<double>(n + 1) * ComplexMath::KernelMath::reciprocal(pw * x) * (-ComplexMath::KernelMath::log(1.0 - x) - sum);
 	};
 
 	complex<double> com_c0(c0[0]-eta[0], c0[1]-eta[1]);
@@ -3641,9 +3717,11 @@ double F3_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, c
 {
 
 	auto accumulateSum =[](complex<double> w,int m) {
-		complex<double> sum = 0.0;
-		for (int k = 1; k <= m; ++k) {
-			sum += 1.0 / static_cast<double>(k) * pow(w, m - k);
+		//k=mʼwݴ
+		complex<double> sum = 0.0, pw = 1.0;
+		for (int k = m; k >= 1; --k) {
+			sum += pw / static_cast<double>(k);
+			pw *= w;
 		}
 		return sum;
 	};
@@ -3669,13 +3747,13 @@ double F3_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, c
 	complex<double> w2_c = conj(w2);
 	complex<double> w3_c = conj(w3);
 
-	complex<double> term1 =- pow(w1_c, m) * log(1.0 - 1.0 / w1_c) - accumulateSum(w1_c, m);
+	complex<double> term1 =- ComplexMath::KernelMath::powi(w1_c, m) * ComplexMath::KernelMath::log(1.0 - ComplexMath::KernelMath::reciprocal(w1_c)) - accumulateSum(w1_c, m);
 	complex<double> denominator1 = b  * (w1_c - w2_c) * (w1_c - w2) * (w1_c - w3_c) * (w1_c - w3);
 
-	complex<double> term2 = -pow(w2_c, m) * log(1.0 - 1.0 / w2_c) - accumulateSum(w2_c, m);
+	complex<double> term2 = -ComplexMath::KernelMath::powi(w2_c, m) * ComplexMath::KernelMath::log(1.0 - ComplexMath::KernelMath::reciprocal(w2_c)) - accumulateSum(w2_c, m);
 	complex<double> denominator2 = d * (w2_c - w1_c) * (w2_c - w1) * (w2_c - w3_c) * (w2_c - w3);
 
-	complex<double> term3 = -pow(w3_c, m) * log(1.0 - 1.0 / w3_c) - accumulateSum(w3_c, m);
+	complex<double> term3 = -ComplexMath::KernelMath::powi(w3_c, m) * ComplexMath::KernelMath::log(1.0 - ComplexMath::KernelMath::reciprocal(w3_c)) - accumulateSum(w3_c, m);
 	complex<double> denominator3 = f * (w3_c - w1_c) * (w3_c - w1) * (w3_c - w2_c) * (w3_c - w2);
 
 	double result = imag(term1 / denominator1) + imag(term2 / denominator2) + imag(term3 / denominator3);
@@ -3686,18 +3764,6 @@ double F3_n(const Mesh::Point eta, const Mesh::Point c0, const Mesh::Point c1, c
 }
 
 
-Mesh::Point evaluate_coor(const std::vector<double> weight, const std::vector<Mesh::Point> ctps)
-{
-	assert(weight.size() == ctps.size());
-	Mesh::Point result(0,0,0);
-	for (int i = 0; i < weight.size(); i++)
-	{
-		result += weight[i] * ctps[i];
-	}
-	//std::cout << result << std::endl;
-	return result;
-}
-
 bool MeshViewerWidget::NearestVertex(OpenMesh::Vec3d objCor, OpenMesh::VertexHandle& minVh)
 {
 	double maxAllowedDis = avgEdgeLength * 0.5;
@@ -3726,86 +3792,37 @@ bool MeshViewerWidget::NearestVertex(OpenMesh::Vec3d objCor, OpenMesh::VertexHan
 	}
 }
 
-bool MeshViewerWidget::NearestCageVertex(OpenMesh::Vec3d objCor, OpenMesh::VertexHandle& minVh)
+bool MeshViewerWidget::NearestCageVertex(OpenMesh::Vec3d objCor, int& minId)
 {
-	//calƽ߳һ
-	double totalLength = 0.0;
-	size_t numEdges = 0;
-	// ȡж
-	std::vector<Mesh::VertexHandle> vhandles;
-	for (const auto& vh : CC_mesh.vertices()) {
-		vhandles.push_back(vh);
-	}
-
-	// ˳ڶ֮ľ
-	for (size_t i = 0; i < vhandles.size(); ++i) {
-		auto vh0 = vhandles[i];
-		auto vh1 = vhandles[(i + 1) % vhandles.size()];  // ѭһ͵һ
-
-		// ȡλ
-		Mesh::Point p0 = CC_mesh.point(vh0);
-		Mesh::Point p1 = CC_mesh.point(vh1);
+	const Cage& edited = editSubCage ? subCagePoints : cage;
+	//ľΪƽ߳һ
+	minId = edited.Nearest(objCor, edited.MeanEdgeLength() * 0.5);
+	return minId >= 0;
+}
+//1bezierߵĿƵתΪʽĿƵ
+void MeshViewerWidget::Bezier1Poly1(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly)
+{
+	curvecage2poly = curvecage2;
+	for (int i = 0; i < curvecage2.size(); i++)
+	{
+		const Mesh::Point& P0 = curvecage2[i][0];
+		const Mesh::Point& P1 = curvecage2[i][1];
+		
 
-		// ŷþ
-		double length = std::sqrt(
-			std::pow(p1[0] - p0[0], 2) +
-			std::pow(p1[1] - p0[1], 2) +
-			std::pow(p1[2] - p0[2], 2)
-		);
+		Mesh::Point a0 = P0;
+		Mesh::Point a1 =(P1 - P0);
+		
 
-		totalLength += length;
-		numEdges++;
+		curvecage2poly[i][0] = a0;
+		curvecage2poly[i][1] = a1;
 	}
+}
 
-	double maxAllowedDis = totalLength/ numEdges * 0.5;
-	double minDis = INFINITY;
-	OpenMesh::VertexHandle mv;
-
-	for (auto vh : CC_mesh.vertices())
-	{
-		auto vp = CC_mesh.point(vh);
-		double dis = (objCor - vp).norm();
-		if (dis < minDis)
-		{
-			minDis = dis;
-			mv = vh;
-		}
-	}
-	//std::cout << minDis << "," << maxAllowedDis << endl;
-	if (minDis <= maxAllowedDis)
-	{
-		minVh = mv;
-		return true;
-	}
-	else
-	{
-		return false;
-	}
-}
-//1bezierߵĿƵתΪʽĿƵ
-void MeshViewerWidget::Bezier1Poly1(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly)
-{
-	curvecage2poly = curvecage2;
-	for (int i = 0; i < curvecage2.size(); i++)
-	{
-		const Mesh::Point& P0 = curvecage2[i][0];
-		const Mesh::Point& P1 = curvecage2[i][1];
-		
-
-		Mesh::Point a0 = P0;
-		Mesh::Point a1 =(P1 - P0);
-		
-
-		curvecage2poly[i][0] = a0;
-		curvecage2poly[i][1] = a1;
-	}
-}
-
-//2bezierߵĿƵתΪʽĿƵ
-void MeshViewerWidget::Bezier2Poly2(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly)
-{
-	curvecage2poly = curvecage2;
-	for (int i = 0; i < curvecage2.size(); i++)
+//2bezierߵĿƵתΪʽĿƵ
+void MeshViewerWidget::Bezier2Poly2(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly)
+{
+	curvecage2poly = curvecage2;
+	for (int i = 0; i < curvecage2.size(); i++)
 	{
 		const Mesh::Point& P0 = curvecage2[i][0];
 		const Mesh::Point& P1 = curvecage2[i][1];
@@ -3996,75 +4013,51 @@ void MeshViewerWidget::Bezier2Poly7(std::vector<std::vector<Mesh::Point>> curvec
 //22Ȩؼ,m=2
 void MeshViewerWidget::calculate_green_weight222(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 2);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
-	
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size()*(2*degree+1));//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly2(curvecage2, poly_Ctps);
-	double max_err=0;
+
+	reset_weights(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
+	weightsDx.setZero(weights.rows(), weights.cols());
+	weightsDy.setZero(weights.rows(), weights.cols());
+	const auto& poly_Ctps = cage.Monomial();
+	//ͬһͬʱȨؼetaĵ
+	GreenCoords::cageWeights(poly_Ctps, mesh.points(), mesh.n_vertices(), weights.data(), weights.cols(), weightsDx.data(), weightsDy.data());
+	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
-		auto vh = mesh.vertex_handle(v_id);
-		Mesh::Point eta = mesh.point(vh);
-		//Mesh::Point eta(0, 0, 0);
-		Mesh::Point test_eta(0, 0, 0);//check equality
+		Mesh::Point eta = mesh.point(mesh.vertex_handle(v_id));
+		Mesh::Point test_eta(0, 0, eta[2]);//check equality
 		for (int i = 0; i < curvecage2.size(); i++)
 		{//iʾ߽ߵĶ
-			auto poly_Ctp = poly_Ctps[i];//ÿһߣԭpoly_ctp
-			auto c0 = poly_Ctp[0]; auto c1 = poly_Ctp[1]; auto c2 = poly_Ctp[2];
-			double F0,F1,F2, F3, F4, F5;
-			F0 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 0);
-			F1 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 1);
-			F2 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 2);
-			F3 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 3);
-			F4 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 4);
-			F5 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 5);
-			weights[v_id][5 * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
-			weights[v_id][5 * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
-			weights[v_id][5 * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3 + (c1).dot(arthono(c2)) * F4;
-			weights[v_id][5 * i + 3] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][5 * i + 4] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + 3 * (c1).dot(c2) * F4 + 2 * c2.dot(c2) * F5 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			test_eta += weights[v_id][5 * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][5 * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][5 * i + 2] * poly_Ctp[2];
-			test_eta += weights[v_id][5 * i + 3] * arthono(poly_Ctp[1]);
-			test_eta += weights[v_id][5 * i + 4] * arthono(poly_Ctp[2]);
+			for (int j = 0; j < degree + 1; j++)
+			{
+				test_eta += weights(v_id, (2 * degree + 1) * i + j) * poly_Ctps[i][j];
+			}
+			for (int j = 1; j < degree + 1; j++)
+			{
+				test_eta += weights(v_id, (2 * degree + 1) * i + degree + j) * arthono(poly_Ctps[i][j]);
+			}
 		}
-		//check
-		/*std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 0) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 1) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 2) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 5) << std::endl;*/
-		//std::cout << eta << endl;
-		//std::cout << "check:" << test_eta-eta << std::endl;
 		if ((test_eta - eta).norm() > max_err)
 			max_err = (test_eta - eta).norm();
 	}
-	std::cout << "max norm err:"<<max_err << std::endl;
-	
-
+	std::cout << "max norm err:" << max_err << std::endl;
 }
 
 //21Ȩؼ,m=2
 void MeshViewerWidget::calculate_green_weight221(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 2);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
 	int N = 2 * todegree + 1;
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * N);//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly2(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * N);//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4082,10 +4075,10 @@ void MeshViewerWidget::calculate_green_weight221(void)
 			F3 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 3);
 			F4 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 4);
 			F5 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 5);
-			weights[v_id][N * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
-			weights[v_id][N * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
+			weights(v_id, N * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
+			weights(v_id, N * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
 			
-			weights[v_id][N * i + 2] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 2) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
 			
 		}
 		//check
@@ -4102,18 +4095,15 @@ void MeshViewerWidget::calculate_green_weight221(void)
 //23Ȩؼ,m=2
 void MeshViewerWidget::calculate_green_weight223(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 2);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
 	int N = 2 * todegree + 1;
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * N);//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly2(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * N);//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4132,13 +4122,13 @@ void MeshViewerWidget::calculate_green_weight223(void)
 			F4 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 4);
 			F5 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 5);
 			F6 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 6);
-			weights[v_id][N * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
-			weights[v_id][N * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
-			weights[v_id][N * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3 + (c1).dot(arthono(c2)) * F4;
-			weights[v_id][N * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4 + (c1).dot(arthono(c2)) * F5;
-			weights[v_id][N * i + 4] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 5] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + 3 * (c1).dot(c2) * F4 + 2 * c2.dot(c2) * F5 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 6] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + 3 * (c1).dot(c2) * F5 + 2 * c2.dot(c2) * F6 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
+			weights(v_id, N * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
+			weights(v_id, N * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3 + (c1).dot(arthono(c2)) * F4;
+			weights(v_id, N * i + 3) = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4 + (c1).dot(arthono(c2)) * F5;
+			weights(v_id, N * i + 4) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 5) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + 3 * (c1).dot(c2) * F4 + 2 * c2.dot(c2) * F5 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 6) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + 3 * (c1).dot(c2) * F5 + 2 * c2.dot(c2) * F6 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
 			
 		}
 		
@@ -4151,18 +4141,15 @@ void MeshViewerWidget::calculate_green_weight223(void)
 //27Ȩؼ,m=2
 void MeshViewerWidget::calculate_green_weight227(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 2);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
 	int N = 2 * todegree + 1;
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * N);//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly2(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * N);//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4185,21 +4172,21 @@ void MeshViewerWidget::calculate_green_weight227(void)
 			F8 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 8);
 			F9 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 9);
 			F10 = F2_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], 10);
-			weights[v_id][N * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
-			weights[v_id][N * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
-			weights[v_id][N * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3 + (c1).dot(arthono(c2)) * F4;
-			weights[v_id][N * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4 + (c1).dot(arthono(c2)) * F5;
-			weights[v_id][N * i + 4] = (c0 - eta).dot(arthono(c1)) * F4 + 2 * (c0 - eta).dot(arthono(c2)) * F5 + (c1).dot(arthono(c2)) * F6;
-			weights[v_id][N * i + 5] = (c0 - eta).dot(arthono(c1)) * F5 + 2 * (c0 - eta).dot(arthono(c2)) * F6 + (c1).dot(arthono(c2)) * F7;
-			weights[v_id][N * i + 6] = (c0 - eta).dot(arthono(c1)) * F6 + 2 * (c0 - eta).dot(arthono(c2)) * F7 + (c1).dot(arthono(c2)) * F8;
-			weights[v_id][N * i + 7] = (c0 - eta).dot(arthono(c1)) * F7 + 2 * (c0 - eta).dot(arthono(c2)) * F8 + (c1).dot(arthono(c2)) * F9;
-			weights[v_id][N * i + 8] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 9] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + 3 * (c1).dot(c2) * F4 + 2 * c2.dot(c2) * F5 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 10] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + 3 * (c1).dot(c2) * F5 + 2 * c2.dot(c2) * F6 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 11] = (c0 - eta).dot(c1) * F4 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F5 + 3 * (c1).dot(c2) * F6 + 2 * c2.dot(c2) * F7 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 12] = (c0 - eta).dot(c1) * F5 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F6 + 3 * (c1).dot(c2) * F7 + 2 * c2.dot(c2) * F8 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 13] = (c0 - eta).dot(c1) * F6 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F7 + 3 * (c1).dot(c2) * F8 + 2 * c2.dot(c2) * F9 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
-			weights[v_id][N * i + 14] = (c0 - eta).dot(c1) * F7 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F8 + 3 * (c1).dot(c2) * F9 + 2 * c2.dot(c2) * F10 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1 + (c1).dot(arthono(c2)) * F2;
+			weights(v_id, N * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2 + (c1).dot(arthono(c2)) * F3;
+			weights(v_id, N * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3 + (c1).dot(arthono(c2)) * F4;
+			weights(v_id, N * i + 3) = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4 + (c1).dot(arthono(c2)) * F5;
+			weights(v_id, N * i + 4) = (c0 - eta).dot(arthono(c1)) * F4 + 2 * (c0 - eta).dot(arthono(c2)) * F5 + (c1).dot(arthono(c2)) * F6;
+			weights(v_id, N * i + 5) = (c0 - eta).dot(arthono(c1)) * F5 + 2 * (c0 - eta).dot(arthono(c2)) * F6 + (c1).dot(arthono(c2)) * F7;
+			weights(v_id, N * i + 6) = (c0 - eta).dot(arthono(c1)) * F6 + 2 * (c0 - eta).dot(arthono(c2)) * F7 + (c1).dot(arthono(c2)) * F8;
+			weights(v_id, N * i + 7) = (c0 - eta).dot(arthono(c1)) * F7 + 2 * (c0 - eta).dot(arthono(c2)) * F8 + (c1).dot(arthono(c2)) * F9;
+			weights(v_id, N * i + 8) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + 3 * (c1).dot(c2) * F3 + 2 * c2.dot(c2) * F4 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 9) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + 3 * (c1).dot(c2) * F4 + 2 * c2.dot(c2) * F5 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 10) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + 3 * (c1).dot(c2) * F5 + 2 * c2.dot(c2) * F6 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 11) = (c0 - eta).dot(c1) * F4 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F5 + 3 * (c1).dot(c2) * F6 + 2 * c2.dot(c2) * F7 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 12) = (c0 - eta).dot(c1) * F5 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F6 + 3 * (c1).dot(c2) * F7 + 2 * c2.dot(c2) * F8 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 13) = (c0 - eta).dot(c1) * F6 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F7 + 3 * (c1).dot(c2) * F8 + 2 * c2.dot(c2) * F9 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
+			weights(v_id, N * i + 14) = (c0 - eta).dot(c1) * F7 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F8 + 3 * (c1).dot(c2) * F9 + 2 * c2.dot(c2) * F10 - log(norm(c0 + c1 + c2 - eta)) / (2 * M_PI);
 
 
 		}
@@ -4214,19 +4201,16 @@ void MeshViewerWidget::calculate_green_weight227(void)
 //13Ȩؼ㣬һε
 void MeshViewerWidget::calculate_specialgreen_weight123(std::vector<int>sp_id)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
-	}
+	reset_weights(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
 	std::vector<std::vector<OpenMesh::Vec3d>> poly_Ctps;
 	poly_Ctps.resize(curvecage2.size());
-	std::vector<std::vector<OpenMesh::Vec3d>> poly_Ctps_pro = curvecage2;
-	Bezier2Poly3(curvecage2, poly_Ctps_pro);
+	const auto& poly_Ctps_pro = cage.Monomial();
 	for(auto spi: sp_id)
 		poly_Ctps[spi] = poly_Ctps_pro[spi];
 	//poly_Ctps[0] = poly_Ctps_pro[0];
@@ -4265,34 +4249,34 @@ void MeshViewerWidget::calculate_specialgreen_weight123(std::vector<int>sp_id)
 			F6 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 6);
 			F7 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 7);
 			F8 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 8);
-			weights[v_id][(2 * degree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
+			weights(v_id, (2 * degree + 1) * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F2 + 2 * c1.dot(arthono(c3)) * F3 + c2.dot(arthono(c3)) * F4;
 
-			weights[v_id][(2 * degree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
+			weights(v_id, (2 * degree + 1) * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F3 + 2 * c1.dot(arthono(c3)) * F4 + c2.dot(arthono(c3)) * F5;
 
-			weights[v_id][(2 * degree + 1) * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
+			weights(v_id, (2 * degree + 1) * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F4 + 2 * c1.dot(arthono(c3)) * F5 + c2.dot(arthono(c3)) * F6;
 
-			weights[v_id][(2 * degree + 1) * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4
+			weights(v_id, (2 * degree + 1) * i + 3) = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F5 + 2 * c1.dot(arthono(c3)) * F6 + c2.dot(arthono(c3)) * F7;
 
-			weights[v_id][(2 * degree + 1) * i + 4] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
+			weights(v_id, (2 * degree + 1) * i + 4) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F4 + 5 * c2.dot(c3) * F5 + 3 * c3.dot(c3) * F6 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * degree + 1) * i + 5] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
+			weights(v_id, (2 * degree + 1) * i + 5) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F5 + 5 * c2.dot(c3) * F6 + 3 * c3.dot(c3) * F7 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * degree + 1) * i + 6] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F5
+			weights(v_id, (2 * degree + 1) * i + 6) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F5
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F6 + 5 * c2.dot(c3) * F7 + 3 * c3.dot(c3) * F8 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			test_eta += weights[v_id][(2 * degree + 1) * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 2] * poly_Ctp[2];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 3] * poly_Ctp[3];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 4] * arthono(poly_Ctp[1]);
-			test_eta += weights[v_id][(2 * degree + 1) * i + 5] * arthono(poly_Ctp[2]);
-			test_eta += weights[v_id][(2 * degree + 1) * i + 6] * arthono(poly_Ctp[3]);
+			test_eta += weights(v_id, (2 * degree + 1) * i + 0) * poly_Ctp[0];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 1) * poly_Ctp[1];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 2) * poly_Ctp[2];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 3) * poly_Ctp[3];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 4) * arthono(poly_Ctp[1]);
+			test_eta += weights(v_id, (2 * degree + 1) * i + 5) * arthono(poly_Ctp[2]);
+			test_eta += weights(v_id, (2 * degree + 1) * i + 6) * arthono(poly_Ctp[3]);
 		}
 		for (int i = 0; i < curvecage2.size(); i++)
 		{//iʾ߽ߵĶ
@@ -4309,27 +4293,27 @@ void MeshViewerWidget::calculate_specialgreen_weight123(std::vector<int>sp_id)
 				F6 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 6);
 				F7 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 7);
 				F8 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 8);
-				weights[v_id][(2 * degree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0;
+				weights(v_id, (2 * degree + 1) * i + 0) = (c0 - eta).dot(arthono(c1)) * F0;
 
-				weights[v_id][(2 * degree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1;
+				weights(v_id, (2 * degree + 1) * i + 1) = (c0 - eta).dot(arthono(c1)) * F1;
 
-				weights[v_id][(2 * degree + 1) * i + 2] = (c0 - eta).dot(arthono(c1)) * F2;
+				weights(v_id, (2 * degree + 1) * i + 2) = (c0 - eta).dot(arthono(c1)) * F2;
 
-				weights[v_id][(2 * degree + 1) * i + 3] = (c0 - eta).dot(arthono(c1)) * F3;
+				weights(v_id, (2 * degree + 1) * i + 3) = (c0 - eta).dot(arthono(c1)) * F3;
 
-				weights[v_id][(2 * degree + 1) * i + 4] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+				weights(v_id, (2 * degree + 1) * i + 4) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-				weights[v_id][(2 * degree + 1) * i + 5] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1)) * F3 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+				weights(v_id, (2 * degree + 1) * i + 5) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1)) * F3 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-				weights[v_id][(2 * degree + 1) * i + 6] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1)) * F4 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+				weights(v_id, (2 * degree + 1) * i + 6) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1)) * F4 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-				test_eta += weights[v_id][(2 * degree + 1) * i + 0] * poly_Ctp[0];
-				test_eta += weights[v_id][(2 * degree + 1) * i + 1] * poly_Ctp[1];
-				test_eta += weights[v_id][(2 * degree + 1) * i + 2] * (OpenMesh::Vec3d(0, 0, 0));
-				test_eta += weights[v_id][(2 * degree + 1) * i + 3] * (OpenMesh::Vec3d(0, 0, 0));
-				test_eta += weights[v_id][(2 * degree + 1) * i + 4] * arthono(poly_Ctp[1]);
-				test_eta += weights[v_id][(2 * degree + 1) * i + 5] * (OpenMesh::Vec3d(0, 0, 0));
-				test_eta += weights[v_id][(2 * degree + 1) * i + 6] * (OpenMesh::Vec3d(0, 0, 0));
+				test_eta += weights(v_id, (2 * degree + 1) * i + 0) * poly_Ctp[0];
+				test_eta += weights(v_id, (2 * degree + 1) * i + 1) * poly_Ctp[1];
+				test_eta += weights(v_id, (2 * degree + 1) * i + 2) * (OpenMesh::Vec3d(0, 0, 0));
+				test_eta += weights(v_id, (2 * degree + 1) * i + 3) * (OpenMesh::Vec3d(0, 0, 0));
+				test_eta += weights(v_id, (2 * degree + 1) * i + 4) * arthono(poly_Ctp[1]);
+				test_eta += weights(v_id, (2 * degree + 1) * i + 5) * (OpenMesh::Vec3d(0, 0, 0));
+				test_eta += weights(v_id, (2 * degree + 1) * i + 6) * (OpenMesh::Vec3d(0, 0, 0));
 			}
 		}
 		//check
@@ -4350,15 +4334,13 @@ void MeshViewerWidget::calculate_specialgreen_weight123(std::vector<int>sp_id)
 //13Ȩؼ
 void MeshViewerWidget::calculate_green_weight123(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
-	}
+	reset_weights(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
 	std::vector<std::vector<OpenMesh::Vec3d>> poly_Ctps;
 	poly_Ctps.resize(curvecage2.size());
 	for (int i = 0; i < poly_Ctps.size(); i++)
@@ -4387,27 +4369,27 @@ void MeshViewerWidget::calculate_green_weight123(void)
 			F6 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 6);
 			F7 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 7);
 			F8 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 8);
-			weights[v_id][(2 * degree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 ;
+			weights(v_id, (2 * degree + 1) * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 ;
 
-			weights[v_id][(2 * degree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 ;
+			weights(v_id, (2 * degree + 1) * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 ;
 
-			weights[v_id][(2 * degree + 1) * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 ;
+			weights(v_id, (2 * degree + 1) * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 ;
 
-			weights[v_id][(2 * degree + 1) * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 ;
+			weights(v_id, (2 * degree + 1) * i + 3) = (c0 - eta).dot(arthono(c1)) * F3 ;
 
-			weights[v_id][(2 * degree + 1) * i + 4] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+			weights(v_id, (2 * degree + 1) * i + 4) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * degree + 1) * i + 5] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1)) * F3  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+			weights(v_id, (2 * degree + 1) * i + 5) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1)) * F3  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * degree + 1) * i + 6] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1)) * F4  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+			weights(v_id, (2 * degree + 1) * i + 6) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1)) * F4  - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
-			test_eta += weights[v_id][(2 * degree + 1) * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 2] * (OpenMesh::Vec3d(0,0,0));
-			test_eta += weights[v_id][(2 * degree + 1) * i + 3] * (OpenMesh::Vec3d(0, 0, 0));
-			test_eta += weights[v_id][(2 * degree + 1) * i + 4] * arthono(poly_Ctp[1]);
-			test_eta += weights[v_id][(2 * degree + 1) * i + 5] * (OpenMesh::Vec3d(0, 0, 0));
-			test_eta += weights[v_id][(2 * degree + 1) * i + 6] * (OpenMesh::Vec3d(0, 0, 0));
+			test_eta += weights(v_id, (2 * degree + 1) * i + 0) * poly_Ctp[0];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 1) * poly_Ctp[1];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 2) * (OpenMesh::Vec3d(0,0,0));
+			test_eta += weights(v_id, (2 * degree + 1) * i + 3) * (OpenMesh::Vec3d(0, 0, 0));
+			test_eta += weights(v_id, (2 * degree + 1) * i + 4) * arthono(poly_Ctp[1]);
+			test_eta += weights(v_id, (2 * degree + 1) * i + 5) * (OpenMesh::Vec3d(0, 0, 0));
+			test_eta += weights(v_id, (2 * degree + 1) * i + 6) * (OpenMesh::Vec3d(0, 0, 0));
 		}
 		//check
 		/*std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 0) << std::endl;
@@ -4426,15 +4408,13 @@ void MeshViewerWidget::calculate_green_weight123(void)
 //11Ȩؼ
 void MeshViewerWidget::calculate_green_weight121(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 1);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
-	}
+	reset_weights(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
 	std::vector<std::vector<OpenMesh::Vec3d>> poly_Ctps;
 	poly_Ctps.resize(curvecage2.size());
 	for (int i = 0; i < poly_Ctps.size(); i++)
@@ -4463,16 +4443,16 @@ void MeshViewerWidget::calculate_green_weight121(void)
 			F6 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 6);
 			F7 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 7);
 			F8 = F1_n(eta, poly_Ctp[0], poly_Ctp[1], 8);
-			weights[v_id][(2 * degree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0;
+			weights(v_id, (2 * degree + 1) * i + 0) = (c0 - eta).dot(arthono(c1)) * F0;
 
-			weights[v_id][(2 * degree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1;
+			weights(v_id, (2 * degree + 1) * i + 1) = (c0 - eta).dot(arthono(c1)) * F1;
 
-			weights[v_id][(2 * degree + 1) * i + 2] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
+			weights(v_id, (2 * degree + 1) * i + 2) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1)) * F2 - log(norm(c0 + c1 - eta)) / (2 * M_PI);
 
 
-			test_eta += weights[v_id][(2 * degree + 1) * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 2] * arthono(poly_Ctp[1]);
+			test_eta += weights(v_id, (2 * degree + 1) * i + 0) * poly_Ctp[0];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 1) * poly_Ctp[1];
+			test_eta += weights(v_id, (2 * degree + 1) * i + 2) * arthono(poly_Ctp[1]);
 			
 		}
 		//check
@@ -4491,18 +4471,15 @@ void MeshViewerWidget::calculate_green_weight121(void)
 //31Ȩؼ
 void MeshViewerWidget::calculate_green_weight321(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
 	int N = 2 * todegree + 1;
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * N);//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly3(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * N);//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4523,18 +4500,18 @@ void MeshViewerWidget::calculate_green_weight321(void)
 			F6 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 6);
 			F7 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 7);
 			F8 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 8);
-			weights[v_id][N * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
+			weights(v_id, N * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F2 + 2 * c1.dot(arthono(c3)) * F3 + c2.dot(arthono(c3)) * F4;
 
-			weights[v_id][N * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
+			weights(v_id, N * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F3 + 2 * c1.dot(arthono(c3)) * F4 + c2.dot(arthono(c3)) * F5;
 
-			weights[v_id][N * i + 2] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
+			weights(v_id, N * i + 2) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F4 + 5 * c2.dot(c3) * F5 + 3 * c3.dot(c3) * F6 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			test_eta += weights[v_id][N * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][N * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][N * i + 2] * arthono(poly_Ctp[1]);
+			test_eta += weights(v_id, N * i + 0) * poly_Ctp[0];
+			test_eta += weights(v_id, N * i + 1) * poly_Ctp[1];
+			test_eta += weights(v_id, N * i + 2) * arthono(poly_Ctp[1]);
 			
 		}
 		
@@ -4546,18 +4523,15 @@ void MeshViewerWidget::calculate_green_weight321(void)
 //32Ȩؼ
 void MeshViewerWidget::calculate_green_weight322(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
 	int N = 2 * todegree + 1;
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * N);//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly3(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * N);//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4578,26 +4552,26 @@ void MeshViewerWidget::calculate_green_weight322(void)
 			F6 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 6);
 			F7 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 7);
 			F8 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 8);
-			weights[v_id][N * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
+			weights(v_id, N * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F2 + 2 * c1.dot(arthono(c3)) * F3 + c2.dot(arthono(c3)) * F4;
 
-			weights[v_id][N * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
+			weights(v_id, N * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F3 + 2 * c1.dot(arthono(c3)) * F4 + c2.dot(arthono(c3)) * F5;
 
-			weights[v_id][N * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
+			weights(v_id, N * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F4 + 2 * c1.dot(arthono(c3)) * F5 + c2.dot(arthono(c3)) * F6;
 
-			weights[v_id][N * i + 3] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
+			weights(v_id, N * i + 3) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F4 + 5 * c2.dot(c3) * F5 + 3 * c3.dot(c3) * F6 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][N * i + 4] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
+			weights(v_id, N * i + 4) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F5 + 5 * c2.dot(c3) * F6 + 3 * c3.dot(c3) * F7 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			test_eta += weights[v_id][N * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][N * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][N * i + 2] * poly_Ctp[2];
-			test_eta += weights[v_id][N * i + 3] * arthono(poly_Ctp[1]);
-			test_eta += weights[v_id][N * i + 4] * arthono(poly_Ctp[2]);
+			test_eta += weights(v_id, N * i + 0) * poly_Ctp[0];
+			test_eta += weights(v_id, N * i + 1) * poly_Ctp[1];
+			test_eta += weights(v_id, N * i + 2) * poly_Ctp[2];
+			test_eta += weights(v_id, N * i + 3) * arthono(poly_Ctp[1]);
+			test_eta += weights(v_id, N * i + 4) * arthono(poly_Ctp[2]);
 
 		}
 
@@ -4608,93 +4582,49 @@ void MeshViewerWidget::calculate_green_weight322(void)
 //33Ȩؼ
 void MeshViewerWidget::calculate_green_weight323(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly3(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * (2 * degree + 1));//ʹеÿʹݻ
+	weightsDx.setZero(weights.rows(), weights.cols());
+	weightsDy.setZero(weights.rows(), weights.cols());
+	const auto& poly_Ctps = cage.Monomial();
+	//ͬһͬʱȨؼetaĵ
+	GreenCoords::cageWeights(poly_Ctps, mesh.points(), mesh.n_vertices(), weights.data(), weights.cols(), weightsDx.data(), weightsDy.data());
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
-		auto vh = mesh.vertex_handle(v_id);
-		Mesh::Point eta = mesh.point(vh);
-		//Mesh::Point eta(0, 0, 0);
-		Mesh::Point test_eta(0, 0, 0);//check equality
+		Mesh::Point eta = mesh.point(mesh.vertex_handle(v_id));
+		Mesh::Point test_eta(0, 0, eta[2]);//check equality
 		for (int i = 0; i < curvecage2.size(); i++)
 		{//iʾ߽ߵĶ
-			auto poly_Ctp = poly_Ctps[i];//ÿһߣԭpoly_ctp
-			auto c0 = poly_Ctp[0]; auto c1 = poly_Ctp[1]; auto c2 = poly_Ctp[2]; auto c3 = poly_Ctp[3];
-			double F0, F1, F2, F3, F4, F5, F6, F7, F8;
-			F0 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 0);
-			F1 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 1);
-			F2 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 2);
-			F3 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 3);
-			F4 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 4);
-			F5 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 5);
-			F6 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 6);
-			F7 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 7);
-			F8 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 8);
-			weights[v_id][(2 * degree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
-				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F2 + 2 * c1.dot(arthono(c3)) * F3 + c2.dot(arthono(c3)) * F4;
-
-			weights[v_id][(2 * degree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
-				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F3 + 2 * c1.dot(arthono(c3)) * F4 + c2.dot(arthono(c3)) * F5;
-
-			weights[v_id][(2 * degree + 1) * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
-				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F4 + 2 * c1.dot(arthono(c3)) * F5 + c2.dot(arthono(c3)) * F6;
-
-			weights[v_id][(2 * degree + 1) * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4
-				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F5 + 2 * c1.dot(arthono(c3)) * F6 + c2.dot(arthono(c3)) * F7;
-
-			weights[v_id][(2 * degree + 1) * i + 4] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
-				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F4 + 5 * c2.dot(c3) * F5 + 3 * c3.dot(c3) * F6 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
-
-			weights[v_id][(2 * degree + 1) * i + 5] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
-				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F5 + 5 * c2.dot(c3) * F6 + 3 * c3.dot(c3) * F7 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
-
-			weights[v_id][(2 * degree + 1) * i + 6] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F5
-				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F6 + 5 * c2.dot(c3) * F7 + 3 * c3.dot(c3) * F8 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
-			
-			test_eta += weights[v_id][(2 * degree + 1) * i + 0] * poly_Ctp[0];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 1] * poly_Ctp[1];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 2] * poly_Ctp[2];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 3] * poly_Ctp[3];
-			test_eta += weights[v_id][(2 * degree + 1) * i + 4] * arthono(poly_Ctp[1]);
-			test_eta += weights[v_id][(2 * degree + 1) * i + 5] * arthono(poly_Ctp[2]);
-			test_eta += weights[v_id][(2 * degree + 1) * i + 6] * arthono(poly_Ctp[3]);
+			for (int j = 0; j < degree + 1; j++)
+			{
+				test_eta += weights(v_id, (2 * degree + 1) * i + j) * poly_Ctps[i][j];
+			}
+			for (int j = 1; j < degree + 1; j++)
+			{
+				test_eta += weights(v_id, (2 * degree + 1) * i + degree + j) * arthono(poly_Ctps[i][j]);
+			}
 		}
-		//check
-		/*std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 0) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 1) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 2) << std::endl;
-		std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 5) << std::endl;*/
-		//std::cout << eta << endl;
-		//std::cout << "check:" << test_eta - eta << std::endl;
 		if ((test_eta - eta).norm() > max_err)
 			max_err = (test_eta - eta).norm();
 	}
 	std::cout << "max norm err:" << max_err << std::endl;
-
 }
 //37Ȩؼ
 void MeshViewerWidget::calculate_green_weight327(void)
 {
+	const auto& curvecage2 = cage.Bezier();
 	assert(degree == 3);
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
 
-	weights.resize(mesh.n_vertices());
-	for (auto& weight : weights) {
-		weight.resize(curvecage2.size() * (2 * todegree + 1));//ʹеÿʹݻ
-	}
-	auto poly_Ctps = curvecage2;
-	Bezier2Poly3(curvecage2, poly_Ctps);
+	reset_weights(curvecage2.size() * (2 * todegree + 1));//ʹеÿʹݻ
+	const auto& poly_Ctps = cage.Monomial();
 	double max_err = 0;
 	for (int v_id = 0; v_id < mesh.n_vertices(); v_id++) {//v_idʾmeshеĵ
 		auto vh = mesh.vertex_handle(v_id);
@@ -4719,69 +4649,69 @@ void MeshViewerWidget::calculate_green_weight327(void)
 			F10 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 10);
 			F11 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 11);
 			F12 = F3_n(eta, poly_Ctp[0], poly_Ctp[1], poly_Ctp[2], poly_Ctp[3], 12);
-			weights[v_id][(2 * todegree + 1) * i + 0] = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
+			weights(v_id, (2 * todegree + 1) * i + 0) = (c0 - eta).dot(arthono(c1)) * F0 + 2 * (c0 - eta).dot(arthono(c2)) * F1
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F2 + 2 * c1.dot(arthono(c3)) * F3 + c2.dot(arthono(c3)) * F4;
 
-			weights[v_id][(2 * todegree + 1) * i + 1] = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
+			weights(v_id, (2 * todegree + 1) * i + 1) = (c0 - eta).dot(arthono(c1)) * F1 + 2 * (c0 - eta).dot(arthono(c2)) * F2
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F3 + 2 * c1.dot(arthono(c3)) * F4 + c2.dot(arthono(c3)) * F5;
 
-			weights[v_id][(2 * todegree + 1) * i + 2] = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
+			weights(v_id, (2 * todegree + 1) * i + 2) = (c0 - eta).dot(arthono(c1)) * F2 + 2 * (c0 - eta).dot(arthono(c2)) * F3
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F4 + 2 * c1.dot(arthono(c3)) * F5 + c2.dot(arthono(c3)) * F6;
 
-			weights[v_id][(2 * todegree + 1) * i + 3] = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4
+			weights(v_id, (2 * todegree + 1) * i + 3) = (c0 - eta).dot(arthono(c1)) * F3 + 2 * (c0 - eta).dot(arthono(c2)) * F4
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F5 + 2 * c1.dot(arthono(c3)) * F6 + c2.dot(arthono(c3)) * F7;
 
-			weights[v_id][(2 * todegree + 1) * i + 4] = (c0 - eta).dot(arthono(c1)) * F4 + 2 * (c0 - eta).dot(arthono(c2)) * F5
+			weights(v_id, (2 * todegree + 1) * i + 4) = (c0 - eta).dot(arthono(c1)) * F4 + 2 * (c0 - eta).dot(arthono(c2)) * F5
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F6 + 2 * c1.dot(arthono(c3)) * F7 + c2.dot(arthono(c3)) * F8;
 
-			weights[v_id][(2 * todegree + 1) * i + 5] = (c0 - eta).dot(arthono(c1)) * F5 + 2 * (c0 - eta).dot(arthono(c2)) * F6
+			weights(v_id, (2 * todegree + 1) * i + 5) = (c0 - eta).dot(arthono(c1)) * F5 + 2 * (c0 - eta).dot(arthono(c2)) * F6
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F7 + 2 * c1.dot(arthono(c3)) * F8 + c2.dot(arthono(c3)) * F9;
 
-			weights[v_id][(2 * todegree + 1) * i + 6] = (c0 - eta).dot(arthono(c1)) * F6 + 2 * (c0 - eta).dot(arthono(c2)) * F7
+			weights(v_id, (2 * todegree + 1) * i + 6) = (c0 - eta).dot(arthono(c1)) * F6 + 2 * (c0 - eta).dot(arthono(c2)) * F7
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F8 + 2 * c1.dot(arthono(c3)) * F9 + c2.dot(arthono(c3)) * F10;
 
-			weights[v_id][(2 * todegree + 1) * i + 7] = (c0 - eta).dot(arthono(c1)) * F7 + 2 * (c0 - eta).dot(arthono(c2)) * F8
+			weights(v_id, (2 * todegree + 1) * i + 7) = (c0 - eta).dot(arthono(c1)) * F7 + 2 * (c0 - eta).dot(arthono(c2)) * F8
 				+ (3 * (c0 - eta).dot(arthono(c3)) + 4 / 3 * (c1).dot(arthono(c2)) + 1 / 3 * c2.dot(arthono(c3))) * F9 + 2 * c1.dot(arthono(c3)) * F10 + c2.dot(arthono(c3)) * F11;
 
-			weights[v_id][(2 * todegree + 1) * i + 8] = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
+			weights(v_id, (2 * todegree + 1) * i + 8) = (c0 - eta).dot(c1) * F1 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F2 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F3
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F4 + 5 * c2.dot(c3) * F5 + 3 * c3.dot(c3) * F6 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 9] = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
+			weights(v_id, (2 * todegree + 1) * i + 9) = (c0 - eta).dot(c1) * F2 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F3 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F4
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F5 + 5 * c2.dot(c3) * F6 + 3 * c3.dot(c3) * F7 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 10] = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F5
+			weights(v_id, (2 * todegree + 1) * i + 10) = (c0 - eta).dot(c1) * F3 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F4 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F5
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F6 + 5 * c2.dot(c3) * F7 + 3 * c3.dot(c3) * F8 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 11] = (c0 - eta).dot(c1) * F4 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F5 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F6
+			weights(v_id, (2 * todegree + 1) * i + 11) = (c0 - eta).dot(c1) * F4 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F5 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F6
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F7 + 5 * c2.dot(c3) * F8 + 3 * c3.dot(c3) * F9 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 12] = (c0 - eta).dot(c1) * F5 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F6 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F7
+			weights(v_id, (2 * todegree + 1) * i + 12) = (c0 - eta).dot(c1) * F5 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F6 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F7
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F8 + 5 * c2.dot(c3) * F9 + 3 * c3.dot(c3) * F10 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 13] = (c0 - eta).dot(c1) * F6 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F7 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F8
+			weights(v_id, (2 * todegree + 1) * i + 13) = (c0 - eta).dot(c1) * F6 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F7 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F8
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F9 + 5 * c2.dot(c3) * F10 + 3 * c3.dot(c3) * F11 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 
-			weights[v_id][(2 * todegree + 1) * i + 14] = (c0 - eta).dot(c1) * F7 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F8 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F9
+			weights(v_id, (2 * todegree + 1) * i + 14) = (c0 - eta).dot(c1) * F7 + (c1.dot(c1) + 2 * (c0 - eta).dot(c2)) * F8 + (3 * (c1).dot(c2) + 3 * (c0 - eta).dot(c3)) * F9
 				+ (2 * c2.dot(c2) + 4 * c1.dot(c3)) * F10 + 5 * c2.dot(c3) * F11 + 3 * c3.dot(c3) * F12 - log(norm(c0 + c1 + c2 + c3 - eta)) / (2 * M_PI);
 			std::vector<std::vector<Mesh::Point>> bezier_ctp7;
 			std::vector<std::vector<Mesh::Point>> poly_Ctp7;
 			Bezier2Bezier7({ curvecage2[i] }, bezier_ctp7);
 			Bezier2Poly7(bezier_ctp7, poly_Ctp7);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 0] * poly_Ctp7[0][0];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 1] * poly_Ctp7[0][1];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 2] * poly_Ctp7[0][2];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 3] * poly_Ctp7[0][3];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 4] * poly_Ctp7[0][4];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 5] * poly_Ctp7[0][5];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 6] * poly_Ctp7[0][6];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 7] * poly_Ctp7[0][7];
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 8] * arthono(poly_Ctp7[0][1]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 9] * arthono(poly_Ctp7[0][2]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 10] * arthono(poly_Ctp7[0][3]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 11] * arthono(poly_Ctp7[0][4]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 12] * arthono(poly_Ctp7[0][5]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 13] * arthono(poly_Ctp7[0][6]);
-			test_eta += weights[v_id][(2 * todegree + 1) * i + 14] * arthono(poly_Ctp7[0][7]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 0) * poly_Ctp7[0][0];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 1) * poly_Ctp7[0][1];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 2) * poly_Ctp7[0][2];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 3) * poly_Ctp7[0][3];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 4) * poly_Ctp7[0][4];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 5) * poly_Ctp7[0][5];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 6) * poly_Ctp7[0][6];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 7) * poly_Ctp7[0][7];
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 8) * arthono(poly_Ctp7[0][1]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 9) * arthono(poly_Ctp7[0][2]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 10) * arthono(poly_Ctp7[0][3]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 11) * arthono(poly_Ctp7[0][4]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 12) * arthono(poly_Ctp7[0][5]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 13) * arthono(poly_Ctp7[0][6]);
+			test_eta += weights(v_id, (2 * todegree + 1) * i + 14) * arthono(poly_Ctp7[0][7]);
 		}
 		//check
 		/*std::cout << F2_n(Mesh::Point{ 0,0,0 }, Mesh::Point{ 1,0,0 }, Mesh::Point{ 0,1,0 }, Mesh::Point{ -0.5,1,0 }, 0) << std::endl;
@@ -4798,92 +4728,37 @@ void MeshViewerWidget::calculate_green_weight327(void)
 }
 
 
-//degreeCCpointsŽcurvecage2
-void MeshViewerWidget::ccPoints2BezierSegs(void)
-{
-	for (int i = 0; i < curvecage2.size(); i++)
-	{
-		for (int j = 0; j < degree + 1; j++)
-		{
-			curvecage2[i][j] = CC_points[i * degree + j];
-		}
-	}
-}
-
-//curvecage2ȷdeformedmeshĶλ
+//cageȷdeformedmeshĶλ
 void MeshViewerWidget::deform_mesh_from_cc(Mesh &deformedmesh)
 {
 	auto arthono = [](const Mesh::Point& p) -> Mesh::Point {
 		return Mesh::Point(p[1], -p[0], p[2]);
 	};
-	auto curvecage2poly = curvecage2;
 	if (usecvm) {
-		//cal mvcGn
+		const auto& curvecage2 = cage.Bezier();
+		//weightsѾgtgnfold_cubicmvc_weightsxyֻǿƵһϣzֲ
 		int N = curvecage2.size();
-		if (1) {
-			std::vector<OpenMesh::Vec3d> t_e(N);
-			std::vector<OpenMesh::Vec3d> n_e(N);
-			for (int i = 0; i < N; i++)
-			{
-				mvcGt[2 * i] = 3 * (curvecage2[i][1] - curvecage2[i][0])/mvcL[i];
-				mvcGt[2 * i + 1] = 3 * (curvecage2[i][2] - curvecage2[i][3]) / mvcL[i];
-				n_e[i] = arthono((curvecage2[i][3] - curvecage2[i][0])).normalized();//ÿߵĵλ
-				t_e[i] = (curvecage2[i][3] - curvecage2[i][0]).normalized();//ÿߵĵλ
-			}
-			for (int i = 0; i < N; i++)
-			{
-				int index = (i - 1) % N;
-				if (index < 0) {
-					index += N;
-				}
-				Eigen::Matrix2d A;
-				Eigen::Matrix2d B;
-				OpenMesh::Vec3d Bx = -mvcGt[2 * index + 1][0] * t_e[index] - mvcGt[2 * i][0] * t_e[i];
-				OpenMesh::Vec3d By = -mvcGt[2 * index + 1][1] * t_e[index] - mvcGt[2 * i][1] * t_e[i];
-				// ΪABֵ
-				A << n_e[i][0], -n_e[index][0],
-					n_e[i][1], -n_e[index][1];
-				B << Bx[0], By[0],
-					Bx[1], By[1];
-				//solve gn
-				Eigen::Matrix2d X = A.inverse() * B;
-				//std::cout << X << std::endl;
-				mvcGn[2 * index + 1] = OpenMesh::Vec3d(X(1, 0), X(1, 1), 0);
-				mvcGn[2 * i] = OpenMesh::Vec3d(X(0, 0), X(0, 1), 0);
-				std::cout << "xݶ" << mvcGt[2 * i][0] * t_e[i] + mvcGn[2 * i][0] * n_e[i] << std::endl;
-				std::cout << "yݶ" << mvcGt[2 * i][1] * t_e[i] + mvcGn[2 * i][1] * n_e[i] << std::endl;
-				std::cout << mvcGt[2 * i][0] * t_e[i] + mvcGn[2 * i][0] * n_e[i] - (-mvcGt[2 * index + 1][0] * t_e[index] + mvcGn[2 * index + 1][0] * n_e[index]) << std::endl;
-				std::cout << mvcGt[2 * i][1] * t_e[i] + mvcGn[2 * i][1] * n_e[i] - (-mvcGt[2 * index + 1][1] * t_e[index] + mvcGn[2 * index + 1][1] * n_e[index]) << std::endl;
-
-			}
-		}
-		for (int i = 0; i < deformedmesh.n_vertices(); i++)
+		Eigen::Matrix<double, Eigen::Dynamic, 2> ctps(3 * N, 2);
+		for (int j = 0; j < N; j++)
 		{
-			auto vh = deformedmesh.vertex_handle(i);
-			auto point = mesh.point(vh);
-			auto weight = weights[i];
-			OpenMesh::Vec3d new_point(0, 0, point[2]);
-			for (int j = 0; j < curvecage2.size(); j++)
+			for (int m = 0; m < 3; m++)
 			{
-				new_point += curvecage2[j][0] * weight[5*j];
-				new_point += mvcGt[2 * j] * weight[5 * j + 1];
-				new_point += mvcGt[2 * j+1] * weight[5 * j +2];
-				new_point += -mvcGn[2 * j] * weight[5 * j + 3];
-				new_point += -mvcGn[2 * j + 1] * weight[5 * j + 4];
+				ctps(3 * j + m, 0) = curvecage2[j][m][0];
+				ctps(3 * j + m, 1) = curvecage2[j][m][1];
 			}
-			
-			deformedmesh.set_point(vh, new_point);
 		}
+		assert(weights.cols() == ctps.rows());
+		CageDeformer::Product(weights, ctps, deformedmesh.points());
+		pin_outside_vertices(deformedmesh);
+		apply_sub_cage(deformedmesh);
+		refine_arap(deformedmesh);
 		return;
 	}
+	//ݻϵλ棬ֻƵĶ
+	const auto& curvecage2poly = cage.Monomial();
 	if (!highdegree) {
-		if (degree == 2)
-			Bezier2Poly2(curvecage2, curvecage2poly);
-		else if (degree == 3)
-			Bezier2Poly3(curvecage2, curvecage2poly);
-		else if (degree == 1)
-			Bezier1Poly1(curvecage2, curvecage2poly);
 		std::vector < Mesh::Point> cpts(curvecage2poly.size() * (2 * degree + 1));
+		assert(weights.cols() == cpts.size());
 		for (int i = 0; i < curvecage2poly.size(); i++)
 		{
 			for (int j = 0; j < degree + 1; j++)
@@ -4895,28 +4770,14 @@ void MeshViewerWidget::deform_mesh_from_cc(Mesh &deformedmesh)
 				cpts[i * (2 * degree + 1) + degree + j] = arthono(curvecage2poly[i][j]);
 			}
 		}
-		for (int i = 0; i < deformedmesh.n_vertices(); i++)
-		{
-			auto vh = deformedmesh.vertex_handle(i);
-			auto weight = weights[i];
-			auto new_point = evaluate_coor(weight, cpts);
-			deformedmesh.set_point(vh, new_point);
-		}
+		//ֿ鲢Уֱд붥飨xyzϵϣ
+		Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>> ctps(cpts.data()->data(), cpts.size(), 3);
+		CageDeformer::Product(weights, Eigen::MatrixXd(ctps), deformedmesh.points());
+		update_jacobian(cpts);
 	}
 	else {
-		if (todegree == 1) {
-			Bezier1Poly1(curvecage2, curvecage2poly);
-		}
-		if (todegree == 2) {
-			Bezier2Poly2(curvecage2, curvecage2poly);
-		}
-		if (todegree == 3) {
-			Bezier2Poly3(curvecage2, curvecage2poly);
-		}
-		if (todegree == 7) {
-			Bezier2Poly7(curvecage2, curvecage2poly);
-		}
 		std::vector < Mesh::Point> cpts(curvecage2poly.size() * (2 * todegree + 1));
+		assert(weights.cols() == cpts.size());
 		for (int i = 0; i < curvecage2poly.size(); i++)
 		{
 			for (int j = 0; j < todegree + 1; j++)
@@ -4928,14 +4789,548 @@ void MeshViewerWidget::deform_mesh_from_cc(Mesh &deformedmesh)
 				cpts[i * (2 * todegree + 1) + todegree + j] = arthono(curvecage2poly[i][j]);
 			}
 		}
-		for (int i = 0; i < deformedmesh.n_vertices(); i++)
+		Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>> ctps(cpts.data()->data(), cpts.size(), 3);
+		CageDeformer::Product(weights, Eigen::MatrixXd(ctps), deformedmesh.points());
+	}
+	pin_outside_vertices(deformedmesh);
+	apply_sub_cage(deformedmesh);
+	refine_arap(deformedmesh);
+}
+
+//·weightsȨֻмǵĺŻдweightsӦ
+void MeshViewerWidget::reset_weights(int cols)
+{
+	deformWorker.Stop();//̨̻߳ڶɵȨ
+	if (session.Recording())
+	{
+		//¼϶ֻü¼ʱȨط
+		session.End();
+		std::cout << "weights changed, drag recording discarded" << std::endl;
+	}
+	proxy.Clear();//µľֹ񣬴´϶ʱؽ
+	clear_sub_cage();//λѾ
+	swap_epoch(history.Retire(mesh.points(), int(mesh.n_vertices())));//ɵȨʷ֮ǰı༭ʱ
+	weights.setZero(mesh.n_vertices(), cols);
+	check_mesh_in_cage();
+	metrics.SetRest(mesh);//Ȩھֹϼ㣬ԴΪ
+	set_arap_rest();//ARAPľֹ״̬Ҳ
+	weightsDx.resize(0, 0);
+	weightsDy.resize(0, 0);
+	jacobianDx.resize(0, 2);
+	jacobianDy.resize(0, 2);
+}
+
+//Ȩ֮ǰļ飺cageⲿcageϵĶõȨû壬¼ڱʱԭλ
+void MeshViewerWidget::check_mesh_in_cage(void)
+{
+	outsideVertices.clear();
+	outsideRest.clear();
+	std::vector<char> side;
+	int n;
+	if (cage.SegmentCount() >= CageBVH::kMinSegments)
+	{
+		//ʱÿֻزνṹ+xĶ
+		cageBVH.Refit(cage);
+		n = cageBVH.ClassifyPoints(mesh.points(), mesh.n_vertices(), side);
+	}
+	else
+	{
+		n = CageGeometry::classifyPoints(cage.Bezier(), mesh.points(), mesh.n_vertices(), side);
+	}
+	if (n == 0)
+		return;
+	int nOn = 0;
+	for (int i = 0; i < side.size(); i++)
+	{
+		if (side[i] == CageGeometry::Inside)
+			continue;
+		outsideVertices.push_back(i);
+		outsideRest.push_back(mesh.point(mesh.vertex_handle(i)));
+		nOn += side[i] == CageGeometry::OnCage;
+	}
+	std::cout << "warning: " << n - nOn << " vertices outside the cage, " << nOn << " on the cage, they are kept fixed" << std::endl;
+}
+
+//꿪ʼ϶cage±ѡеĿƵ㣬Ϊ϶̷Bezierκϵ
+void MeshViewerWidget::begin_cage_drag(void)
+{
+	(editSubCage ? subCagePoints : cage).SelectedIds(movingCagePoints);
+	deformPending = false;
+	dragMoves = dragFrames = 0;
+	dragDeformMs = dragMaxDeformMs = 0;
+	if (editSubCage)
+		return;
+	if (!movingCagePoints.empty())
+		dragStart = cage.At(movingCagePoints[0]);
+	cageDeformer.Reset(cage, usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis);
+	//Ȩصб˵ĻƵMVCͼԵǰcageΪֹ״̬°
+	if (!layers.Empty() && !layers.Bound(cageDeformer.Columns()))
+		layers.Bind(cage.Bezier(), [this](const Mesh::Point* pts, int n, WeightMatrix& W) { layer_weights(pts, n, W); });
+}
+
+//϶ƶĿƵػǰͳһΣBezierκԽ⣬ٱ񲢼¼ʱ
+void MeshViewerWidget::apply_pending_deformation(void)
+{
+	deformTimer.start();
+	if (deformWorker.Acquire())
+	{
+		//̨̱߳ʱֻȡɵһ֡㡢Jacobianͼͻcageһ֡λ
+		const auto& frame = deformWorker.Front();
+		frameCage.SetPoints(frame.cage);
+		Mesh& target = proxyActive ? proxy.GetMesh() : mesh;
+		std::copy(frame.points.begin(), frame.points.end(), target.points());
+		if (frame.jacobianDx.rows() == weights.rows())
 		{
-			auto vh = deformedmesh.vertex_handle(i);
-			auto weight = weights[i];
-			auto new_point = evaluate_coor(weight, cpts);
-			deformedmesh.set_point(vh, new_point);
+			jacobianDx = frame.jacobianDx;
+			jacobianDy = frame.jacobianDy;
 		}
+		if (!proxyActive)
+		{
+			apply_sub_cage(mesh);//̵̨߳ĶJacobiancageλ
+			sub_cage_jacobian(true);
+			//ARAPⲻÿһ֡һɿ
+		}
+		deform_layers(frame.coeffs);//ͬһ֡ϵ
+		check_cage_self_intersection();
+	}
+	else if (deformPending && editSubCage)
+	{
+		//ֲ༭ֻcageڲλƣಿֵĴС޹
+		deformPending = false;
+		arap.Restore(mesh.points(), int(mesh.n_vertices()));
+		sub_cage_jacobian(false);
+		subCage.Update(mesh.points());
+		sub_cage_jacobian(true);
+		refine_arap(mesh);
+	}
+	else if (deformPending)
+	{
+		deformPending = false;
+		cageDeformer.Update(cage);//ֻؽƶĶεϵ
+		check_cage_self_intersection();
+		if (mvcpreview)
+		{
+			//ԤֻÿƶεMVCֵɿ
+			for (auto vh : mesh.vertices())
+			{
+				auto w = previewWeights.row(vh.idx());
+				Mesh::Point p(0, 0, mesh.point(vh)[2]);
+				for (int k = 0; k < cage.Size(); k++)
+				{
+					p[0] += w[k] * cage.X(k);
+					p[1] += w[k] * cage.Y(k);
+				}
+				mesh.set_point(vh, p);
+			}
+		}
+		else if (weights.rows() == mesh.n_vertices() && weights.cols() == cageDeformer.Columns())
+		{
+			//ϵѰƶĶθ£ֱдmeshĶ
+			//ӳϵԵģƽʱֻϱ仯гϵۻ
+			bool jacobian = weightsDx.rows() == weights.rows() && weightsDx.cols() == weights.cols();
+			arap.Restore(mesh.points(), int(mesh.n_vertices()));
+			subCage.Remove(mesh.points());//ڸcageĽۼ
+			sub_cage_jacobian(false);
+			if (cageDeformer.FullUpdateDue())
+			{
+				cageDeformer.Deform(weights, mesh.points());
+				if (jacobian)
+				{
+					cageDeformer.Apply(weightsDx, jacobianDx);
+					cageDeformer.Apply(weightsDy, jacobianDy);
+				}
+			}
+			else
+			{
+				cageDeformer.DeformChanged(weights, mesh.points());
+				if (jacobian)
+				{
+					cageDeformer.ApplyChanged(weightsDx, jacobianDx);
+					cageDeformer.ApplyChanged(weightsDy, jacobianDy);
+				}
+			}
+			cageDeformer.Commit();
+			pin_outside_vertices(mesh);
+			apply_sub_cage(mesh);
+			sub_cage_jacobian(true);
+			refine_arap(mesh);
+		}
+		else
+		{
+			Mesh deformedMesh;
+			deformedMesh.assign(mesh);
+			deform_mesh_from_cc(deformedMesh);//ͨımeshĶλ
+			MeshTools::AssignPoints(mesh, deformedMesh);
+		}
+		if (!mvcpreview)
+			deform_layers(cageDeformer.Coefficients());
 	}
+	else
+		return;
+	double ms = deformTimer.nsecsElapsed() * 1e-6;
+	dragFrames++;
+	dragDeformMs += ms;
+	dragMaxDeformMs = std::max(dragMaxDeformMs, ms);
+}
+
+//Ȩcageһʱ϶ıν̨̣߳϶ڼweightsı
+void MeshViewerWidget::start_deform_worker(void)
+{
+	if (weights.rows() != mesh.n_vertices() || weights.cols() != cageDeformer.Columns())
+		return;
+	frameCage = cage;//յһ֮֡ǰǰʱcage
+	auto published = [this] { QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection); };
+	if (mesh.n_vertices() >= ProxyMesh::kMinVertices)
+	{
+		//϶ʱֻκͻƼɿٱ
+		if (proxy.Empty())
+			proxy.Build(mesh);
+		proxy.Sync(mesh);
+		proxy.SelectRows(weights, proxyWeights);
+		proxy.MapVertices(outsideVertices, proxyPinned);
+		proxyActive = true;
+		const Mesh& pm = proxy.GetMesh();
+		deformWorker.Start(proxyWeights, nullptr, nullptr,
+			cage, usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis,
+			pm.points(), int(pm.n_vertices()), proxyPinned, published);
+		return;
+	}
+	bool jacobian = weightsDx.rows() == weights.rows() && weightsDx.cols() == weights.cols();
+	arap.Restore(mesh.points(), int(mesh.n_vertices()));//϶е֡ARAPcageεĽ
+	deformWorker.Start(weights, jacobian ? &weightsDx : nullptr, jacobian ? &weightsDy : nullptr,
+		cage, usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis,
+		mesh.points(), int(mesh.n_vertices()), outsideVertices, published);
+}
+
+//϶յĿƵһ
+void MeshViewerWidget::deform_full_resolution(void)
+{
+	cageDeformer.Update(cage);
+	cageDeformer.Deform(weights, mesh.points());
+	if (weightsDx.rows() == weights.rows() && weightsDx.cols() == weights.cols())
+	{
+		cageDeformer.Apply(weightsDx, jacobianDx);
+		cageDeformer.Apply(weightsDy, jacobianDy);
+	}
+	cageDeformer.Commit();
+	pin_outside_vertices(mesh);
+	apply_sub_cage(mesh);
+	sub_cage_jacobian(true);
+	refine_arap(mesh);
+	deform_layers(cageDeformer.Coefficients());
+}
+
+//cageλãcage.Points()ͬеĿƵ㣩µλõϵһweightsֻһ
+//framesδŸλõĶ㣬ÿλmesh.n_vertices()
+bool MeshViewerWidget::deform_poses(const std::vector<std::vector<Mesh::Point>>& poses, std::vector<Mesh::Point>& frames)
+{
+	int n = int(mesh.n_vertices());
+	if (poses.empty() || weights.rows() != n || int(poses[0].size()) != cage.Size())
+		return false;
+	Cage pose = cage;//λд룬ϵֻؽ˵Ķ
+	CageDeformer poseDeformer;
+	poseDeformer.Reset(pose, usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis);
+	if (weights.cols() != poseDeformer.Columns())
+	{
+		std::cout << "deform_poses: weights do not match the cage" << std::endl;
+		return false;
+	}
+	QElapsedTimer timer;
+	timer.start();
+	int P = int(poses.size());
+	Eigen::MatrixXd coeffs(poseDeformer.Columns(), 2 * P);
+	for (int p = 0; p < P; p++)
+	{
+		pose.SetPoints(poses[p]);
+		poseDeformer.Update(pose);
+		coeffs.middleCols(2 * p, 2) = poseDeformer.Coefficients();
+	}
+	std::vector<double> z(n);
+	for (int i = 0; i < n; i++)
+	{
+		z[i] = mesh.point(mesh.vertex_handle(i))[2];
+	}
+	frames.resize(std::size_t(P) * n);
+	CageDeformer::DeformPoses(weights, coeffs, z.data(), frames.data());
+	for (int p = 0; p < P; p++)
+	{
+		for (int i = 0; i < outsideVertices.size(); i++)
+		{
+			frames[std::size_t(p) * n + outsideVertices[i]] = outsideRest[i];
+		}
+		subCage.AddDisplacement(frames.data() + std::size_t(p) * n);
+	}
+	double s = timer.nsecsElapsed() * 1e-9;
+	std::cout << P << " poses x " << n << " vertices in " << s * 1000 << " ms, " << double(P) * n / s << " vertex-poses/s" << std::endl;
+	return true;
+}
+
+//cageдtargetĶ֮cageĿƵƶټϾֲελ
+void MeshViewerWidget::apply_sub_cage(Mesh& target)
+{
+	if (subCage.Empty())
+		return;
+	subCage.Apply(target.points());
+	sync_sub_cage_points();
+}
+
+//cageı༭cageľֲȨ򶥵㵱ǰλáƶcage¼
+void MeshViewerWidget::rebind_sub_cage(void)
+{
+	if (subCage.Empty() || proxyActive)
+		return;
+	arap.Restore(mesh.points(), int(mesh.n_vertices()));
+	sub_cage_jacobian(false);
+	subCage.Rebind(mesh.points());
+	sync_sub_cage_points();
+	sub_cage_jacobian(true);
+	refine_arap(mesh);
+}
+
+//cageڵJacobiancageJacobianд󸴺ϾֲӳĵǰظcageĲ
+void MeshViewerWidget::sub_cage_jacobian(bool apply)
+{
+	if (subCage.Empty() || jacobianDx.rows() != mesh.n_vertices() || jacobianDy.rows() != mesh.n_vertices())
+		return;
+	if (apply)
+		subCage.ApplyJacobian(jacobianDx, jacobianDy);
+	else
+		subCage.RemoveJacobian(jacobianDx, jacobianDy);
+}
+
+void MeshViewerWidget::sync_sub_cage_points(void)
+{
+	subCagePoints.SetPoints(subCage.Points());
+}
+
+void MeshViewerWidget::clear_sub_cage(void)
+{
+	subCage.Clear();
+	subCagePoints.Clear();
+	editSubCage = false;
+}
+
+//ɿ꣺϶ΪһʷֻƶĿƵܵλ
+void MeshViewerWidget::record_cage_move(bool adjust)
+{
+	if (editSubCage || movingCagePoints.empty())
+		return;
+	Mesh::Point delta = cage.At(movingCagePoints[0]) - dragStart;
+	if (delta.sqrnorm() > 0)
+		history.PushMove(movingCagePoints, delta, adjust);
+}
+
+CageHistory::CageState MeshViewerWidget::cage_state(void) const
+{
+	CageHistory::CageState state;
+	state.ccPoints = cage.Points();
+	state.degree = degree;
+	state.todegree = todegree;
+	state.highdegree = highdegree;
+	state.usecvm = usecvm;
+	state.epoch = history.CurrentEpoch();
+	return state;
+}
+
+void MeshViewerWidget::set_cage_state(const CageHistory::CageState& state)
+{
+	degree = state.degree;
+	todegree = state.todegree;
+	highdegree = state.highdegree;
+	usecvm = state.usecvm;
+	cage.Reset(state.ccPoints, highdegree ? todegree : degree);
+}
+
+//һȨضӦݣȨءԭλĶ㣩彻
+void MeshViewerWidget::swap_epoch(CageHistory::Epoch& epoch)
+{
+	weights.swap(epoch.weights);
+	weightsDx.swap(epoch.weightsDx);
+	weightsDy.swap(epoch.weightsDy);
+	outsideVertices.swap(epoch.pinned);
+	outsideRest.swap(epoch.pinnedRest);
+	jacobianDx.resize(0, 2);
+	jacobianDy.resize(0, 2);
+}
+
+//֮ǰȨأARAPľֹ״̬Ҳɼʱ
+void MeshViewerWidget::switch_epoch(int epoch)
+{
+	deformWorker.Stop();
+	proxy.Clear();
+	clear_sub_cage();
+	swap_epoch(history.Switch(epoch));
+	const auto& rest = history.Rest();
+	if (rest.size() != mesh.n_vertices())
+		return;
+	std::vector<Mesh::Point> current(mesh.points(), mesh.points() + mesh.n_vertices());
+	std::copy(rest.begin(), rest.end(), mesh.points());
+	metrics.SetRest(mesh);
+	set_arap_rest();
+	std::copy(current.begin(), current.end(), mesh.points());
+}
+
+void MeshViewerWidget::apply_history_step(const CageHistory::Step& step, bool undo)
+{
+	if (session.Recording())
+	{
+		session.End();
+		std::cout << "cage changed by " << (undo ? "undo" : "redo") << ", drag recording discarded" << std::endl;
+	}
+	int epoch = step.TargetEpoch(undo);
+	if (epoch != history.CurrentEpoch())
+		switch_epoch(epoch);
+	if (step.kind == CageHistory::Move)
+	{
+		Mesh::Point delta = undo ? -step.delta : step.delta;
+		cage.MovePoints(step.ids.data(), int(step.ids.size()), delta);
+	}
+	else if (step.kind == CageHistory::Rebuild)
+		set_cage_state(undo ? step.before : step.after);
+	else if (undo)
+		cage.Erase(step.index, int(step.points.size()));
+	else
+		cage.Insert(step.index, step.points);
+	std::cout << (undo ? "undo " : "redo ") << CageHistory::KindName(step.kind) << ", " << history.UndoCount() << " steps to undo, "
+		<< history.RedoCount() << " to redo" << std::endl;
+
+	//ƵˣȨֵһΣ϶еһ֡ͬ
+	check_cage_self_intersection();
+	cageDeformer.Reset(cage, usecvm ? CageDeformer::ControlPoints : CageDeformer::PowerBasis);
+	if (!step.adjust && weights.rows() == mesh.n_vertices() && weights.cols() == cageDeformer.Columns())
+	{
+		deform_full_resolution();
+		rebind_sub_cage();
+	}
+	update();
+}
+
+//ARAPľֹ񻻳ɵǰmeshϸʱֽ⣬϶взֽĿ
+void MeshViewerWidget::set_arap_rest(void)
+{
+	arap.SetRest(mesh);
+	if (araprefine)
+		arap.Factorize();
+}
+
+//cageΣcageдtarget֮ΪֵԼARAPķֽ϶֮临
+//֮ǰҪarap.RestorecageεĽ
+void MeshViewerWidget::refine_arap(Mesh& target)
+{
+	if (araprefine)
+		arap.Refine(target.points(), int(target.n_vertices()), outsideVertices);
+}
+
+//ͼ浱ǰλãеϵcageDeformer̵̨߳һ֡һĶһγ˻
+void MeshViewerWidget::deform_layers(const Eigen::Matrix<double, Eigen::Dynamic, 2>& coeffs)
+{
+	if (!layers.Empty() && layers.Bound(int(coeffs.rows())))
+		layers.Deform(coeffs);
+}
+
+//ͼȨweightsͬһУMVCʱǿƶϵcubicMVCs۵ľ󣬷ݻµGreenȨ
+void MeshViewerWidget::layer_weights(const Mesh::Point* pts, int n, WeightMatrix& W) const
+{
+	int N = cage.SegmentCount();
+	if (usecvm)
+	{
+		std::vector<OpenMesh::Vec3d> polygon(N);
+		for (int s = 0; s < N; s++)
+		{
+			polygon[s] = cage.At(cage.Offset(s));
+		}
+		WeightMatrix W5 = WeightMatrix::Zero(n, 5 * N);
+		if (n > 0)
+			MVC::cubicMVCs(polygon, pts, n, W5.data(), int(W5.cols()));
+		W = W5 * cubicmvc_fold();
+		return;
+	}
+	int cols = 0;
+	for (int s = 0; s < N; s++)
+	{
+		cols += 2 * cage.SegmentDegree(s) + 1;
+	}
+	W.setZero(n, cols);
+	if (n > 0)
+		GreenCoords::cageWeights(cage.Monomial(), pts, n, W.data(), cols);
+}
+
+//ͼԼͷţmeshͼ㲻
+void MeshViewerWidget::clear_layers(void)
+{
+	makeCurrent();
+	for (int l = 0; l < layers.Count(); l++)
+	{
+		unsigned int texture = layers.GetLayer(l).texture;
+		if (texture != glTextureID)
+			glDeleteTextures(1, &texture);
+	}
+	doneCurrent();
+	layers.Clear();
+}
+
+//ͼԼʱmesh
+unsigned int MeshViewerWidget::load_layer_texture(const std::string& filename)
+{
+	int width, height, nChannels;
+	unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nChannels, 0);
+	if (!data)
+	{
+		std::cout << "Failed to load texture " << filename << std::endl;
+		return glTextureID;
+	}
+	GLint format = nChannels == 1 ? GL_RED : nChannels == 2 ? GL_RG : nChannels == 3 ? GL_RGB : GL_RGBA;
+	unsigned int texture;
+	makeCurrent();
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	doneCurrent();
+	stbi_image_free(data);
+	return texture;
+}
+
+void MeshViewerWidget::pin_outside_vertices(Mesh& deformedmesh)
+{
+	for (int i = 0; i < outsideVertices.size(); i++)
+	{
+		deformedmesh.set_point(deformedmesh.vertex_handle(outsideVertices[i]), outsideRest[i]);
+	}
+}
+
+//϶cageʱԽBVHֻƶĶΣཻĶDrawCurveCageб죻ǻcage
+void MeshViewerWidget::check_cage_self_intersection(void)
+{
+	const Cage& shown = shown_cage();
+	cageBVH.Refit(shown);//ֻȡ汾˵Ķ
+	auto& pairs = cagePairs;
+	cageBVH.SelfIntersections(pairs);
+	bool wasCrossed = std::find(cageSegmentCrossed.begin(), cageSegmentCrossed.end(), 1) != cageSegmentCrossed.end();
+	cageSegmentCrossed.assign(shown.SegmentCount(), 0);
+	for (const auto& pr : pairs)
+	{
+		cageSegmentCrossed[pr.first] = 1;
+		cageSegmentCrossed[pr.second] = 1;
+	}
+	if (!pairs.empty() && !wasCrossed)
+		std::cout << "warning: cage self-intersects (segments " << pairs[0].first << " and " << pairs[0].second << ")" << std::endl;
+	else if (pairs.empty() && wasCrossed)
+		std::cout << "cage is no longer self-intersecting" << std::endl;
+}
+
+//εJacobiani jacobianDx = df/dxjacobianDy = df/dyfxyαһֻһξ˷
+void MeshViewerWidget::update_jacobian(const std::vector<Mesh::Point>& cpts)
+{
+	if (weightsDx.rows() != weights.rows() || weightsDx.cols() != int(cpts.size()))
+		return;
+	Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 2, Eigen::RowMajor>, 0, Eigen::OuterStride<3>> ctps(cpts.data()->data(), cpts.size(), 2);
+	jacobianDx.noalias() = weightsDx * ctps;
+	jacobianDy.noalias() = weightsDy * ctps;
+	sub_cage_jacobian(true);//cageٸϾֲӳ
 }
 
 void MeshViewerWidget::Set_Texture_coord()
@@ -5162,26 +5557,26 @@ void MeshViewerWidget::DrawBezierCurve(const BezierCurve& bezierCurve, float r,
 	}
 }
 
-void MeshViewerWidget::DrawTexture()
+void MeshViewerWidget::DrawTexture(const Mesh& texMesh, unsigned int texture)
 {
 
 	glShadeModel(GL_SMOOTH);
 
-	glBindTexture(GL_TEXTURE_2D, glTextureID);
+	glBindTexture(GL_TEXTURE_2D, texture);
 
 	glEnable(GL_TEXTURE_2D);//2D
 
 	std::vector<Triangle> triangles;
 
 	// Step 1: Extract triangles and calculate their center z-coordinate
-	for (auto f_it = mesh.faces_begin(); f_it != mesh.faces_end(); ++f_it)
+	for (auto f_it = texMesh.faces_begin(); f_it != texMesh.faces_end(); ++f_it)
 	{
 		Triangle tri;
 		int i = 0;
-		for (auto fv_it = mesh.fv_begin(*f_it); fv_it != mesh.fv_end(*f_it); ++fv_it, ++i)
+		for (auto fv_it = texMesh.fv_begin(*f_it); fv_it != texMesh.fv_end(*f_it); ++fv_it, ++i)
 		{
-			tri.vertices[i] = mesh.point(*fv_it);
-			tri.texcoords[i] = mesh.texcoord2D(*fv_it);
+			tri.vertices[i] = texMesh.point(*fv_it);
+			tri.texcoords[i] = texMesh.texcoord2D(*fv_it);
 		}
 		tri.zCenter = (tri.vertices[0][2] + tri.vertices[1][2] + tri.vertices[2][2]) / 3.0f;
 		triangles.push_back(tri);
@@ -5233,62 +5628,61 @@ void MeshViewerWidget::DrawTexture()
 
 void MeshViewerWidget::DrawCageWireframe(void)
 {
+	const Cage& shown = shown_cage();
 	glColor3d(0.2, 0.2, 0.2);
-	glBegin(GL_LINES);
-	// ȡж
-	std::vector<Mesh::VertexHandle> vhandles;
-	for (const auto& vh : CC_mesh.vertices()) {
-		vhandles.push_back(vh);
-	}
-
-	// ˳ڵĶ
-	for (size_t i = 0; i < vhandles.size(); ++i) {
-		auto vh0 = vhandles[i];
-		auto vh1 = vhandles[(i + 1) % vhandles.size()];  // ѭһ͵һ
-		glVertex3dv(CC_mesh.point(vh0).data());
-		glVertex3dv(CC_mesh.point(vh1).data());
+	// ˳ڵĿƵ㣬һصһ
+	glBegin(GL_LINE_LOOP);
+	for (int i = 0; i < shown.Size(); i++)
+	{
+		glVertex3d(shown.X(i), shown.Y(i), 0);
 	}
 	glEnd();
-	
 }
 
 void MeshViewerWidget::DrawCagePoints(void)
-{	
-	auto CC_vertexState = OpenMesh::getProperty<OpenMesh::VertexHandle, VertexState>(CC_mesh, "vertexState");
+{
+	//ѡȡԱ༭еcageλȡԻһ֡
+	const Cage& edited = editSubCage ? subCagePoints : cage;
+	const Cage& shown = editSubCage ? subCagePoints : shown_cage();
 	glColor3d(0.2, 0.2, 0.2);
 	glPointSize(5);
 	glBegin(GL_POINTS);
-	for (const auto& vh : CC_mesh.vertices())
+	for (int i = 0; i < edited.Size(); i++)
 	{
-		if (CC_vertexState[vh] == NotSelected)
-		{
-			
-			glVertex3dv(CC_mesh.point(vh).data());
-		}
+		if (!edited.Selected(i))
+			glVertex3d(shown.X(i), shown.Y(i), 0);
 	}
 	glEnd();
-	
+
 	glColor3d(1.0, 0.0, 0.0);
 	glPointSize(50);
 	glBegin(GL_POINTS);
-	for (const auto& vh : CC_mesh.vertices())
+	for (int i = 0; i < edited.Size(); i++)
 	{
-		if (CC_vertexState[vh] == Custom)
-		{
-			
-			glVertex3dv(CC_mesh.point(vh).data());
-		}
+		if (edited.Selected(i))
+			glVertex3d(shown.X(i), shown.Y(i), 0);
 	}
 	glEnd();
 }
 
 void MeshViewerWidget::DrawCurveCage(void)
 {
-	int N = curvecage2.size();
-	std::cout << N << std::endl;
+	//̨̱߳ʱͬһ֡ĿƵ㣬ֱӴcage
+	const Cage& shown = shown_cage();
+	std::vector<Mesh::Point> seg;
+	int N = shown.SegmentCount();
 	for (int i = 0; i < N; i++) {
-		DrawBezierCurve(curvecage2[i],0,0,1);
-		//DrawPoints3d(curvecage2[i], 0, 1, 0);
+		shown.Segment(i, seg);
+		if (i < cageSegmentCrossed.size() && cageSegmentCrossed[i])
+			DrawBezierCurve(seg, 1, 0, 0);
+		else
+			DrawBezierCurve(seg,0,0,1);
+		//DrawPoints3d(seg, 0, 1, 0);
+	}
+	for (int i = 0; i < subCagePoints.SegmentCount(); i++)
+	{
+		subCagePoints.Segment(i, seg);
+		DrawBezierCurve(seg, 0, 0.6, 0);
 	}
 	
 	//DrawFlat();
@@ -5299,11 +5693,57 @@ void MeshViewerWidget::DrawCurveCage(void)
 	//DrawCageWireframe();
 	//DrawCagePoints();
 	glColor3d(1.0, 1.0, 1.0);
-	DrawTexture();
+	DrawTexture(proxyActive ? proxy.GetMesh() : mesh, glTextureID);
+	for (int l = 0; l < layers.Count(); l++)
+	{
+		DrawTexture(layers.GetLayer(l).mesh, layers.GetLayer(l).texture);
+	}
+	if (drawdistortion && !proxyActive)
+	{
+		//ֻжƶ¼ӦΣɫmetrics
+		if (metrics.Update(mesh))
+			emit DistortionInfoSignal(DistortionInfo());
+		DrawDistortion();
+	}
 	
 	//DrawFlat();
 }
 
+void MeshViewerWidget::DrawDistortion(void)
+{
+	const Mesh::Point* pts = mesh.points();
+	const int* tris = metrics.Triangles();
+	const float* colors = metrics.FaceColors();
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBegin(GL_TRIANGLES);
+	for (int f = 0; f < metrics.FaceCount(); f++)
+	{
+		if (colors[4 * f + 3] == 0.0f)
+			continue;
+		glColor4fv(colors + 4 * f);
+		for (int i = 0; i < 3; i++)
+		{
+			glVertex3dv(pts[tris[3 * f + i]].data());
+		}
+	}
+	glEnd();
+	glPopAttrib();
+}
+
+QString MeshViewerWidget::DistortionInfo(void) const
+{
+	const auto& s = metrics.GetSummary();
+	return QString("max distortion: %1\narea ratio: %2 ~ %3\nflipped: %4")
+		.arg(s.maxDistortion, 0, 'f', 3)
+		.arg(s.minAreaRatio, 0, 'f', 3)
+		.arg(s.maxAreaRatio, 0, 'f', 3)
+		.arg(s.flipped);
+}
+
 void MeshViewerWidget::DrawBoundingBox(void) const
 {
 	float linewidth;
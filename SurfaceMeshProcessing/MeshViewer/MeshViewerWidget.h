@@ -2,12 +2,27 @@
 #include <QString>
 #include <QEvent>
 #include <QMouseEvent>
+#include <QKeyEvent>
+#include <QElapsedTimer>
 #include "QGLViewerWidget.h"
 #include <OpenMesh/Core/Utils/PropertyManager.hh>
 #include "MeshDefinition.h"
 
 #include "BezierCurve.h"
 #include "MVC.h"
+#include "GreenCoords.h"
+#include "DistortionMetrics.h"
+#include "CageBVH.h"
+#include "CageDeformer.h"
+#include "DeformWorker.h"
+#include "ProxyMesh.h"
+#include "CageAnimation.h"
+#include "DragSession.h"
+#include "SubCage.h"
+#include "CageLayers.h"
+#include "ArapRefiner.h"
+#include "CageHistory.h"
+#include "Cage.h"
 
 class MeshViewerWidget : public QGLViewerWidget
 {
@@ -41,6 +56,7 @@ public:
 	void LoadRotation(void);
 signals:
 	void LoadMeshOKSignal(bool, QString);
+	void DistortionInfoSignal(QString);
 public slots:
 	void PrintMeshInfo(void);
 	void SelectSMAdjust(void);
@@ -50,15 +66,26 @@ public slots:
 	void SetSMChangedegree(void);
 	void SetSMNodrawpoint(void);
 	void SetSMAddpoints(void);
+	void SetSMMVCPreview(void);
+	void SetSMDistortion(void);
+	void SetSMAddKeyframe(void);
+	void SetSMRenderAnimation(void);
+	void SetSMRecordSession(void);
+	void SetSMSubCage(void);
+	void SetSMAddLayer(void);
+	void SetSMArapRefine(void);
+	void SetSMUndo(void);
+	void SetSMRedo(void);
 	void SetSMNoSelect(void);
 	void ClearSelected(void);
 protected:
 	virtual bool event(QEvent* _event) override;
+	virtual void keyPressEvent(QKeyEvent* _event) override;
 	virtual void mouseDoubleClickEvent(QMouseEvent* _event) override;
 	virtual void DrawScene(void) override;
 	void DrawSceneMesh(void);
 	bool NearestVertex(OpenMesh::Vec3d objCor, OpenMesh::VertexHandle& minVh);
-	bool NearestCageVertex(OpenMesh::Vec3d objCor, OpenMesh::VertexHandle& minVh);
+	bool NearestCageVertex(OpenMesh::Vec3d objCor, int& minId);
 	void Bezier1Poly1(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly);
 	void Bezier2Poly2(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly);
 	void Bezier2Poly3(std::vector<std::vector<Mesh::Point>> curvecage2, std::vector<std::vector<Mesh::Point>>& curvecage2poly);
@@ -80,8 +107,37 @@ protected:
 	void calculate_green_weight322(void);
 	void calculate_green_weight323(void);
 	void calculate_green_weight327(void);
-	void ccPoints2BezierSegs(void);
 	void deform_mesh_from_cc(Mesh& deformedmesh);
+	void fold_cubicmvc_weights(void);
+	Eigen::MatrixXd cubicmvc_fold(void) const;
+	void reset_weights(int cols);
+	void check_mesh_in_cage(void);
+	void pin_outside_vertices(Mesh& deformedmesh);
+	void check_cage_self_intersection(void);
+	const Cage& shown_cage(void) const { return deformWorker.Running() ? frameCage : cage; }
+	void begin_cage_drag(void);
+	void apply_pending_deformation(void);
+	void start_deform_worker(void);
+	void deform_full_resolution(void);
+	bool deform_poses(const std::vector<std::vector<Mesh::Point>>& poses, std::vector<Mesh::Point>& frames);
+	void apply_sub_cage(Mesh& target);
+	void sync_sub_cage_points(void);
+	void rebind_sub_cage(void);
+	void sub_cage_jacobian(bool apply);
+	void clear_sub_cage(void);
+	void deform_layers(const Eigen::Matrix<double, Eigen::Dynamic, 2>& coeffs);
+	void layer_weights(const Mesh::Point* pts, int n, WeightMatrix& W) const;
+	void clear_layers(void);
+	void refine_arap(Mesh& target);
+	void set_arap_rest(void);
+	void record_cage_move(bool adjust);
+	CageHistory::CageState cage_state(void) const;
+	void set_cage_state(const CageHistory::CageState& state);
+	void swap_epoch(CageHistory::Epoch& epoch);
+	void switch_epoch(int epoch);
+	void apply_history_step(const CageHistory::Step& step, bool undo);
+	unsigned int load_layer_texture(const std::string& filename);
+	void update_jacobian(const std::vector<Mesh::Point>& cpts);
 	void Set_Texture_coord();
 
 private:
@@ -92,26 +148,61 @@ private:
 	void DrawFlat(void);
 	void DrawSmooth(void);
 	void DrawBezierCurve(const BezierCurve& bezierCurve, float r = 1.0f, float g = 0.0f, float b = 0.0f, float linewidth = 1.0);
-	void DrawTexture();
+	void DrawTexture(const Mesh& texMesh, unsigned int texture);
 	void DrawCageWireframe(void);
 	void DrawCagePoints(void);
 	void DrawCurveCage(void);
+	void DrawDistortion(void);
+	QString DistortionInfo(void) const;
 	void DrawBoundingBox(void) const;
 	void DrawBoundary(void) const;
 protected:
 	Mesh mesh;
-	Mesh CC_mesh;//ƵɵCC_pointsʼmoveжλ÷ı
+	std::vector<int> vertexOrder;//ʱ㰴HilbertţvertexOrder[i]Ϊiļе
+	Cage cage;//Ƶ㣨ֻһݣεĴͰ汾ѡԼλݻϵ༭ʱֻƶĶ
 	int degree = 3;
 	int todegree = 7;
 	bool highdegree = false;
 	bool usecvm = false;
 	bool drawpoints = true;
-	std::vector<std::vector<Mesh::Point>> curvecage2;//ɶbezierߵĿƵ㣬߰ʱ˳
-	std::vector<Mesh::Point > CC_points;//ʼcurvecage2еĿƵʱһڣı䣺costumemoveʱ
-	std::vector<Mesh::Point> mvcGn;
-	std::vector<Mesh::Point> mvcGt;
-	std::vector<double> mvcL;
-	std::vector<std::vector<double>> weights;
+	bool mvcpreview = false;//϶ʱÿƶεMVCԤ
+	bool araprefine = false;//ģʽGreenκARAPֲָ
+	bool drawdistortion = false;//ϵÿεĹλ䣬תΪɫ
+	WeightMatrix weights;//ÿжӦһ񶥵
+	WeightMatrix weightsDx;//weightsԶxĵĿǰcalculate_green_weight222/323
+	WeightMatrix weightsDy;
+	Eigen::Matrix<double, Eigen::Dynamic, 2> jacobianDx;//ÿ㴦εdf/dxdeform_mesh_from_cc
+	Eigen::Matrix<double, Eigen::Dynamic, 2> jacobianDy;
+	WeightMatrix previewWeights;//϶ʼʱ񶥵cageƵMVCȨ
+	std::vector<int> outsideVertices;//ȨʱcageڲcageϣĶ㣬ʱԭλ
+	std::vector<Mesh::Point> outsideRest;
+	Cage frameCage;//̨̱߳ʱȡõһ֡ӦĿƵ㣬cageһ
+	CageBVH cageBVH;//cageοƶΰΧеĲνṹ϶cageʱ
+	std::vector<char> cageSegmentCrossed;//ڵĶཻĶΣúɫ
+	std::vector<std::pair<int, int>> cagePairs;//ԽĶζԣʹ϶ʱٷ
+	CageDeformer cageDeformer;//϶ʱĿƵ㡢Bezierκϵʱã϶ԭظ
+	std::vector<int> movingCagePoints;//϶ĿƵ
+	bool deformPending = false;//Ƶƶһػ棬һ֡ڵĶƶֻһ
+	QElapsedTimer deformTimer;
+	int dragMoves = 0, dragFrames = 0;//һ϶еƶʵʱδ
+	double dragDeformMs = 0, dragMaxDeformMs = 0;
+	DeformWorker deformWorker;//϶ʱں̨̱߳Σweightsweights֮
+	ProxyMesh proxy;//϶ʱmeshκͻƵļӹϵڵһ϶ʱ
+	WeightMatrix proxyWeights;//proxyӦweights
+	std::vector<int> proxyPinned;//proxyбԭλĶ
+	bool proxyActive = false;
+	CageAnimation animation;//ؼ֡ΪcageƵĸλãȾʱ֡βд
+	DragSession session;//¼е϶¼޽طźͱȽϲͬ汾ӳ
+	SubCage subCage;//Ƕڸcage֮ڵľֲcageֲȨֻڲĶ
+	Cage subCagePoints;//cageĿƵѡ񣬱༭cageʱcageѡ϶
+	bool editSubCage = false;
+	OpenMesh::Vec3d lastClickCor;//һ˫λãµcageûѡпƵʱҲӵ
+	bool hasClickCor = false;
+	CageLayers layers;//meshcage񣨱ȣж϶ʱһ
+	CageHistory history;//cage༭ĳ/ֻ¼Ƶı仯֮ǰȨذ
+	Mesh::Point dragStart;//϶ʼʱһ϶ĿƵ㣬ɿʱõ϶λ
+	ArapRefiner arap;//ARAPϸľֹͻķֽ⣬ԼһcageεĽ
+	DistortionMetrics metrics;//ڼȨʱλ䣬ֻڶƶ
 	QString strMeshFileName;
 	QString strMeshBaseName;
 	QString strMeshPath;
@@ -0,0 +1,99 @@
+#include "ProxyMesh.h"
+#include <algorithm>
+#include <limits>
+#include <OpenMesh/Tools/Decimater/DecimaterT.hh>
+#include <OpenMesh/Tools/Decimater/ModEdgeLengthT.hh>
+#include <OpenMesh/Tools/Decimater/ModNormalFlippingT.hh>
+
+void ProxyMesh::Build(const Mesh& mesh, int targetVertices)
+{
+	typedef OpenMesh::Decimater::DecimaterT<Mesh> Decimater;
+	typedef OpenMesh::Decimater::ModEdgeLengthT<Mesh>::Handle HModEdgeLength;
+	typedef OpenMesh::Decimater::ModNormalFlippingT<Mesh>::Handle HModNormalFlipping;
+
+	m_Mesh = mesh;
+	OpenMesh::VPropHandleT<int> source;
+	m_Mesh.add_property(source);
+	for (auto vh : m_Mesh.vertices())
+	{
+		m_Mesh.property(source, vh) = vh.idx();
+		m_Mesh.status(vh).set_locked(m_Mesh.is_boundary(vh));
+	}
+	m_Mesh.update_face_normals();
+
+	// the meshes are planar, every quadric error is zero: shortest edges first keeps the
+	// triangles even, and the normal check rejects collapses that would flip a triangle
+	Decimater decimater(m_Mesh);
+	HModEdgeLength hLength;
+	HModNormalFlipping hFlipping;
+	decimater.add(hLength);
+	decimater.add(hFlipping);
+	decimater.module(hLength).set_binary(false);
+	decimater.module(hLength).set_edge_length(std::numeric_limits<float>::max());
+	decimater.initialize();
+	decimater.decimate_to(targetVertices);
+	m_Mesh.garbage_collection();
+
+	m_Source.resize(m_Mesh.n_vertices());
+	m_ProxyOf.assign(mesh.n_vertices(), -1);
+	for (auto vh : m_Mesh.vertices())
+	{
+		m_Mesh.status(vh).set_locked(false);
+		m_Source[vh.idx()] = m_Mesh.property(source, vh);
+		m_ProxyOf[m_Source[vh.idx()]] = vh.idx();
+	}
+	m_Mesh.remove_property(source);
+	std::cout << "proxy mesh: " << m_Mesh.n_vertices() << " of " << mesh.n_vertices() << " vertices, "
+		<< m_Mesh.n_faces() << " faces" << std::endl;
+}
+
+void ProxyMesh::Clear(void)
+{
+	m_Mesh.clear();
+	m_Source.clear();
+	m_ProxyOf.clear();
+}
+
+void ProxyMesh::Sync(const Mesh& mesh)
+{
+	bool tex = mesh.has_vertex_texcoords2D();
+	if (tex && !m_Mesh.has_vertex_texcoords2D())
+		m_Mesh.request_vertex_texcoords2D();
+	for (int i = 0; i < int(m_Source.size()); i++)
+	{
+		auto vh = mesh.vertex_handle(m_Source[i]);
+		auto ph = m_Mesh.vertex_handle(i);
+		m_Mesh.set_point(ph, mesh.point(vh));
+		if (tex)
+			m_Mesh.set_texcoord2D(ph, mesh.texcoord2D(vh));
+	}
+}
+
+void ProxyMesh::SelectRows(const WeightMatrix& weights, WeightMatrix& rows) const
+{
+	rows.resize(m_Source.size(), weights.cols());
+	for (int i = 0; i < int(m_Source.size()); i++)
+	{
+		rows.row(i) = weights.row(m_Source[i]);
+	}
+}
+
+void ProxyMesh::MapVertices(const std::vector<int>& meshVertices, std::vector<int>& proxyVertices) const
+{
+	proxyVertices.clear();
+	for (int v : meshVertices)
+	{
+		if (m_ProxyOf[v] >= 0)
+			proxyVertices.push_back(m_ProxyOf[v]);
+	}
+}
+
+double ProxyMesh::Mismatch(const Mesh& mesh) const
+{
+	double d = 0.0;
+	for (int i = 0; i < int(m_Source.size()); i++)
+	{
+		d = std::max(d, (m_Mesh.point(m_Mesh.vertex_handle(i)) - mesh.point(mesh.vertex_handle(m_Source[i]))).norm());
+	}
+	return d;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "MeshDefinition.h"
+
+// Decimated stand-in for a large mesh while its cage is dragged. The decimation only collapses
+// halfedges into one of their vertices, so every proxy vertex is a mesh vertex: its weight row
+// is a row of the mesh weights and it has the mesh's texture coordinate. Boundary vertices are
+// locked, the outline of the proxy is the outline of the mesh.
+class ProxyMesh
+{
+public:
+	// meshes with fewer vertices are dragged at full resolution
+	static const int kMinVertices = 60000;
+	static const int kTargetVertices = 15000;
+
+public:
+	// decimates a copy of mesh, the connectivity is kept until the next Build or Clear
+	void Build(const Mesh& mesh, int targetVertices = kTargetVertices);
+	void Clear(void);
+	bool Empty() const { return m_Source.empty(); }
+
+	// positions and texture coordinates of the proxy vertices from their mesh vertices
+	void Sync(const Mesh& mesh);
+	// rows of the mesh weights at the proxy vertices
+	void SelectRows(const WeightMatrix& weights, WeightMatrix& rows) const;
+	// the proxy vertices among the given mesh vertices
+	void MapVertices(const std::vector<int>& meshVertices, std::vector<int>& proxyVertices) const;
+	// largest distance between a proxy vertex and its mesh vertex, the jump seen when the mesh
+	// is drawn again in place of the proxy
+	double Mismatch(const Mesh& mesh) const;
+
+	Mesh& GetMesh() { return m_Mesh; }
+	const Mesh& GetMesh() const { return m_Mesh; }
+
+private:
+	Mesh m_Mesh;
+	std::vector<int> m_Source;//mesh vertex of every proxy vertex
+	std::vector<int> m_ProxyOf;//proxy vertex of every mesh vertex, -1 if it was collapsed
+};
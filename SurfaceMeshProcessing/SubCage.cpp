@@ -0,0 +1,239 @@
+#include "SubCage.h"
+#include "CageGeometry.h"
+#include "GreenCoords.h"
+
+int SubCage::Build(const Mesh& mesh, const std::vector<Point>& ccPoints, int degree, const std::vector<int>& fixed)
+{
+	Clear();
+	int n = int(mesh.n_vertices());
+	const Point* pts = mesh.points();
+	Cage rest;
+	rest.Reset(ccPoints, degree);
+
+	std::vector<char> side;
+	CageGeometry::classifyPoints(rest.Bezier(), pts, n, side);
+	std::vector<char> isFixed(n, 0);
+	for (int v : fixed)
+	{
+		isFixed[v] = 1;
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (side[i] == CageGeometry::Inside && !isFixed[i])
+			m_Region.push_back(i);
+	}
+	if (m_Region.empty())
+		return 0;
+
+	int nRegion = int(m_Region.size());
+	std::vector<Point> regionPts(nRegion);
+	for (int i = 0; i < nRegion; i++)
+	{
+		regionPts[i] = pts[m_Region[i]];
+	}
+	Bind(ccPoints, degree, regionPts);
+
+	m_Offsets.Reset(std::vector<Point>(ccPoints.size(), Point(0, 0, 0)), degree);
+	m_Deformer.Reset(m_Offsets, CageDeformer::PowerBasis);
+	m_Displacement.assign(nRegion, Point(0, 0, 0));
+	m_GradX.setZero(nRegion, 2);
+	m_GradY.setZero(nRegion, 2);
+
+	// anchor every control point in the triangle under it, or at the nearest vertex off the mesh
+	m_Anchors.resize(ccPoints.size());
+	for (int p = 0; p < int(ccPoints.size()); p++)
+	{
+		const Point& q = ccPoints[p];
+		Anchor& anchor = m_Anchors[p];
+		bool found = false;
+		for (auto fh : mesh.faces())
+		{
+			int k = 0;
+			for (const auto& fvh : mesh.fv_range(fh))
+			{
+				anchor.v[k++] = fvh.idx();
+			}
+			const Point& a = pts[anchor.v[0]];
+			const Point& b = pts[anchor.v[1]];
+			const Point& c = pts[anchor.v[2]];
+			double det = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+			if (det == 0)
+				continue;
+			double l1 = ((q[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (q[1] - a[1])) / det;
+			double l2 = ((b[0] - a[0]) * (q[1] - a[1]) - (q[0] - a[0]) * (b[1] - a[1])) / det;
+			double l0 = 1 - l1 - l2;
+			if (l0 >= -1e-12 && l1 >= -1e-12 && l2 >= -1e-12)
+			{
+				anchor.b[0] = l0;
+				anchor.b[1] = l1;
+				anchor.b[2] = l2;
+				anchor.offset = q - (l0 * a + l1 * b + l2 * c);
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			int nearest = 0;
+			for (int i = 1; i < n; i++)
+			{
+				if ((pts[i] - q).sqrnorm() < (pts[nearest] - q).sqrnorm())
+					nearest = i;
+			}
+			anchor.v[0] = anchor.v[1] = anchor.v[2] = nearest;
+			anchor.b[0] = 1;
+			anchor.b[1] = anchor.b[2] = 0;
+			anchor.offset = q - pts[nearest];
+		}
+	}
+	m_Images = ccPoints;
+	UpdatePoints();
+	return nRegion;
+}
+
+void SubCage::Bind(const std::vector<Point>& ccPoints, int degree, const std::vector<Point>& regionPts)
+{
+	Cage rest;
+	rest.Reset(ccPoints, degree);
+	int nRegion = int(regionPts.size());
+	int K = CageDeformer::Columns(rest, CageDeformer::PowerBasis);
+	m_Weights.setZero(nRegion, K);
+	m_WeightsDx.setZero(nRegion, K);
+	m_WeightsDy.setZero(nRegion, K);
+	GreenCoords::cageWeights(rest.Monomial(), regionPts.data(), nRegion, m_Weights.data(), K, m_WeightsDx.data(), m_WeightsDy.data());
+}
+
+void SubCage::Clear(void)
+{
+	m_Region.clear();
+	m_Weights.resize(0, 0);
+	m_WeightsDx.resize(0, 0);
+	m_WeightsDy.resize(0, 0);
+	m_JacobianApplied = false;
+	m_Displacement.clear();
+	m_Anchors.clear();
+	m_Images.clear();
+	m_Points.clear();
+	m_Offsets.Clear();
+}
+
+void SubCage::UpdatePoints(void)
+{
+	const auto& offsets = m_Offsets.Points();
+	m_Points.resize(m_Images.size());
+	for (int p = 0; p < int(m_Images.size()); p++)
+	{
+		m_Points[p] = m_Images[p] + offsets[p];
+	}
+}
+
+void SubCage::MovePoints(const int* ids, int n, const Point& delta)
+{
+	if (Empty())
+		return;
+	m_Offsets.MovePoints(ids, n, delta);
+	UpdatePoints();
+}
+
+void SubCage::Remove(Point* pts) const
+{
+	for (int i = 0; i < int(m_Region.size()); i++)
+	{
+		pts[m_Region[i]] -= m_Displacement[i];
+	}
+}
+
+void SubCage::AddDisplacement(Point* pts) const
+{
+	for (int i = 0; i < int(m_Region.size()); i++)
+	{
+		pts[m_Region[i]] += m_Displacement[i];
+	}
+}
+
+void SubCage::Apply(Point* pts)
+{
+	if (Empty())
+		return;
+	for (int p = 0; p < int(m_Anchors.size()); p++)
+	{
+		const Anchor& anchor = m_Anchors[p];
+		m_Images[p] = anchor.b[0] * pts[anchor.v[0]] + anchor.b[1] * pts[anchor.v[1]] + anchor.b[2] * pts[anchor.v[2]] + anchor.offset;
+	}
+	UpdatePoints();
+	AddDisplacement(pts);
+}
+
+void SubCage::Update(Point* pts)
+{
+	if (Empty())
+		return;
+	Remove(pts);
+	// the displacement is linear in the offsets: only the columns of moved segments change
+	m_Deformer.Update(m_Offsets);
+	if (m_Deformer.FullUpdateDue())
+	{
+		m_Deformer.Deform(m_Weights, m_Displacement.data());
+		m_Deformer.Apply(m_WeightsDx, m_GradX);
+		m_Deformer.Apply(m_WeightsDy, m_GradY);
+	}
+	else
+	{
+		m_Deformer.DeformChanged(m_Weights, m_Displacement.data());
+		m_Deformer.ApplyChanged(m_WeightsDx, m_GradX);
+		m_Deformer.ApplyChanged(m_WeightsDy, m_GradY);
+	}
+	m_Deformer.Commit();
+	AddDisplacement(pts);
+}
+
+void SubCage::Rebind(Point* pts)
+{
+	if (Empty())
+		return;
+	Remove(pts);
+	int nRegion = int(m_Region.size());
+	std::vector<Point> regionPts(nRegion);
+	for (int i = 0; i < nRegion; i++)
+	{
+		regionPts[i] = pts[m_Region[i]];
+	}
+	// the images are the local cage without the offsets, whose map is the identity on the region
+	Bind(m_Images, m_Offsets.Degree(), regionPts);
+	m_Deformer.Update(m_Offsets);
+	m_Deformer.Deform(m_Weights, m_Displacement.data());
+	m_Deformer.Apply(m_WeightsDx, m_GradX);
+	m_Deformer.Apply(m_WeightsDy, m_GradY);
+	m_Deformer.Commit();
+	AddDisplacement(pts);
+}
+
+void SubCage::ApplyJacobian(Eigen::Matrix<double, Eigen::Dynamic, 2>& jx, Eigen::Matrix<double, Eigen::Dynamic, 2>& jy)
+{
+	if (Empty())
+		return;
+	int nRegion = int(m_Region.size());
+	m_ParentDx.resize(nRegion, 2);
+	m_ParentDy.resize(nRegion, 2);
+	for (int i = 0; i < nRegion; i++)
+	{
+		int v = m_Region[i];
+		m_ParentDx.row(i) = jx.row(v);
+		m_ParentDy.row(i) = jy.row(v);
+		// chain rule through q = parent map: d(q + D(q)) = (I + [dD/dx dD/dy]) dq
+		jx.row(v) += m_ParentDx(i, 0) * m_GradX.row(i) + m_ParentDx(i, 1) * m_GradY.row(i);
+		jy.row(v) += m_ParentDy(i, 0) * m_GradX.row(i) + m_ParentDy(i, 1) * m_GradY.row(i);
+	}
+	m_JacobianApplied = true;
+}
+
+void SubCage::RemoveJacobian(Eigen::Matrix<double, Eigen::Dynamic, 2>& jx, Eigen::Matrix<double, Eigen::Dynamic, 2>& jy) const
+{
+	if (Empty() || !m_JacobianApplied)
+		return;
+	for (int i = 0; i < int(m_Region.size()); i++)
+	{
+		jx.row(m_Region[i]) = m_ParentDx.row(i);
+		jy.row(m_Region[i]) = m_ParentDy.row(i);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include "Cage.h"
+#include "CageDeformer.h"
+
+// A local cage nested in the deformation of the parent cage. It is placed over the mesh as it
+// is drawn and covers a region of vertices; only these get local weights (Green coordinates of
+// the local cage at their positions). Each control point is anchored in the mesh triangle
+// under it, so the local cage rides on the parent map, and moving its control points adds the
+// local map of the offsets, W_local * C(offsets), to the region on top of the parent result.
+// The coefficients are linear in the control points, so an unedited sub-cage leaves the mesh
+// as it is, and a local edit costs region vertices x local columns whatever the size of the
+// rest of the mesh. During a parent drag the local weights stay those of the last binding, so
+// the displacement is carried along rather than re-evaluated; Rebind() evaluates them again at
+// the region's new positions inside the moved local cage once the parent edit is done. The
+// Jacobian of the region composes the local map with the parent one, J = (I + dD/dq) J_parent.
+class SubCage
+{
+public:
+	typedef Mesh::Point Point;
+
+public:
+	// ccPoints: closed cage of Bezier segments of the given degree, counterclockwise, over the
+	// current mesh; fixed vertices (e.g. outside the parent cage) stay out of the region.
+	// Returns the number of region vertices.
+	int Build(const Mesh& mesh, const std::vector<Point>& ccPoints, int degree, const std::vector<int>& fixed);
+	void Clear(void);
+	bool Empty() const { return m_Region.empty(); }
+	const std::vector<int>& Region() const { return m_Region; }
+	// control points where they are drawn: images of the anchors plus the local offsets
+	const std::vector<Point>& Points() const { return m_Points; }
+
+	void MovePoints(const int* ids, int n, const Point& delta);
+	// pts hold the parent map plus the applied displacement; subtract it before a parent
+	// update that adds to pts instead of overwriting them
+	void Remove(Point* pts) const;
+	// pts hold the parent map only: re-anchor the control points and add the displacement
+	void Apply(Point* pts);
+	// after MovePoints(): replaces the applied displacement of the region by the current one
+	void Update(Point* pts);
+	// adds the current displacement to another point set of the same mesh (e.g. an animation frame)
+	void AddDisplacement(Point* pts) const;
+	// pts as after Apply(): local weights again at the parent positions of the region inside the
+	// local cage as it is drawn now, then the displacement with them
+	void Rebind(Point* pts);
+
+	// jx/jy: df/dx, df/dy of the parent map for every mesh vertex; the region rows are composed
+	// with the derivative of the displacement, and put back by RemoveJacobian() before an update
+	// that adds to the parent Jacobian instead of overwriting it
+	void ApplyJacobian(Eigen::Matrix<double, Eigen::Dynamic, 2>& jx, Eigen::Matrix<double, Eigen::Dynamic, 2>& jy);
+	void RemoveJacobian(Eigen::Matrix<double, Eigen::Dynamic, 2>& jx, Eigen::Matrix<double, Eigen::Dynamic, 2>& jy) const;
+
+private:
+	// a point as barycentric combination of three mesh vertices plus a fixed offset, which is
+	// zero for points inside the mesh
+	struct Anchor {
+		int v[3];
+		double b[3];
+		Point offset;
+	};
+	void UpdatePoints(void);
+	// m_Weights and the derivative weights at the region points for the local cage over ccPoints
+	void Bind(const std::vector<Point>& ccPoints, int degree, const std::vector<Point>& regionPts);
+
+private:
+	std::vector<int> m_Region;
+	WeightMatrix m_Weights;//one row per region vertex
+	WeightMatrix m_WeightsDx, m_WeightsDy;
+	Cage m_Offsets;//the local control points as offsets from their images, zero where not edited
+	CageDeformer m_Deformer;//coefficients of m_Offsets
+	std::vector<Point> m_Displacement;//per region vertex, as last added to the mesh
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_GradX, m_GradY;//d(displacement)/dx, /dy per region vertex
+	Eigen::Matrix<double, Eigen::Dynamic, 2> m_ParentDx, m_ParentDy;//region rows before ApplyJacobian()
+	bool m_JacobianApplied = false;
+	std::vector<Anchor> m_Anchors;
+	std::vector<Point> m_Images;
+	std::vector<Point> m_Points;
+};
@@ -0,0 +1,102 @@
+// Checks that a cage drag does not allocate once it is running: every mouse move edits the
+// Cage, updates the coefficient rows of the moved segments (CageDeformer::Update), deforms the
+// points and the Jacobian incrementally or in full, refits the BVH and collects the self-
+// intersecting pairs, as MeshViewerWidget does for one painted frame. Built in
+// SurfaceMeshProcessing/ from the sources it tests, e.g.
+//   g++ -O2 -fopenmp -std=c++14 -D_USE_MATH_DEFINES -I. Tests/DragAllocationTest.cpp Cage.cpp
+//       CageDeformer.cpp CageBVH.cpp CageGeometry.cpp GreenCoords.cpp -lOpenMeshCore
+// and returns non-zero when a move allocated.
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include "Cage.h"
+#include "CageBVH.h"
+#include "CageDeformer.h"
+#include "GreenCoords.h"
+
+static long g_Allocations = 0;
+
+void* operator new(std::size_t n)
+{
+	g_Allocations++;
+	void* p = std::malloc(n ? n : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main()
+{
+	typedef Mesh::Point Point;
+	const int kSegments = 12, kDegree = 3, kVertices = 20000, kMoves = 100;
+
+	// a circle of cubic segments over random points inside it
+	std::vector<Point> ccPoints;
+	for (int i = 0; i < kSegments * kDegree; i++)
+	{
+		double t = 2 * M_PI * i / (kSegments * kDegree);
+		ccPoints.push_back(Point(10 * std::cos(t), 10 * std::sin(t), 0));
+	}
+	Cage cage;
+	cage.Reset(ccPoints, kDegree);
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> coord(-6, 6);
+	std::vector<Point> pts(kVertices);
+	for (auto& p : pts)
+	{
+		p = Point(coord(gen), coord(gen), 0);
+	}
+	int K = CageDeformer::Columns(cage, CageDeformer::PowerBasis);
+	WeightMatrix weights(kVertices, K), weightsDx(kVertices, K), weightsDy(kVertices, K);
+	GreenCoords::cageWeights(cage.Monomial(), pts.data(), kVertices, weights.data(), K, weightsDx.data(), weightsDy.data());
+
+	CageDeformer deformer;
+	deformer.Reset(cage, CageDeformer::PowerBasis);
+	CageBVH bvh;
+	bvh.Refit(cage);
+	std::vector<std::pair<int, int>> pairs;
+	Eigen::Matrix<double, Eigen::Dynamic, 2> jacobianDx(kVertices, 2), jacobianDy(kVertices, 2);
+	std::vector<int> moving = { 0, 7, 8 };
+
+	auto move = [&](const Point& delta) {
+		cage.MovePoints(moving.data(), int(moving.size()), delta);
+		deformer.Update(cage);
+		bvh.Refit(cage);
+		bvh.SelfIntersections(pairs);
+		if (deformer.FullUpdateDue())
+		{
+			deformer.Deform(weights, pts.data());
+			deformer.Apply(weightsDx, jacobianDx);
+			deformer.Apply(weightsDy, jacobianDy);
+		}
+		else
+		{
+			deformer.DeformChanged(weights, pts.data());
+			deformer.ApplyChanged(weightsDx, jacobianDx);
+			deformer.ApplyChanged(weightsDy, jacobianDy);
+		}
+		deformer.Commit();
+	};
+	// the first move brings the thread pool and the scratch buffers up
+	move(Point(0.01, 0, 0));
+	long before = g_Allocations;
+	for (int k = 0; k < kMoves; k++)
+	{
+		move(Point(0.02 * std::sin(k), 0.015 * std::cos(k), 0));
+	}
+	long allocations = g_Allocations - before;
+	if (allocations != 0)
+	{
+		std::cerr << "ERROR: " << allocations << " allocations in " << kMoves << " cage moves" << std::endl;
+		return 1;
+	}
+	std::cout << kMoves << " cage moves without allocation" << std::endl;
+	return 0;
+}
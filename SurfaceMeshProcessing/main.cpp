@@ -1,7 +1,11 @@
 #include "surfacemeshprocessing.h"
+#include "DragSession.h"
 
 int main(int argc, char *argv[])
 {
+	// headless: replay a recorded drag session and print its latency and checksum
+	if (argc == 3 && std::string(argv[1]) == "--replay")
+		return DragSession::ReplayFile(argv[2]) ? 0 : 1;
 	QApplication app(argc, argv);
 	QSurfaceFormat format;
 	format.setSamples(0);